@@ -1,5 +1,12 @@
 #include "upfirlerp.h"
+#include "fixed.h"
+#include "async.h"
 #include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <string>
+#include <utility>
 
 #include <catch2/catch_test_macros.hpp>
 // Also include benchmarking headers, i don't really know which one is necessary
@@ -134,3 +141,1001 @@ TEST_CASE("benchmark doubles, taps length 100, input len 100000, output len 2000
 
     };
 }
+
+
+
+// Long filters at high upsample rates, as in production.
+// The polyphase bank makes each interrim sample a dense dot product of ceil(taps/up) length,
+// so cost should scale with taps/up rather than taps.
+TEST_CASE("benchmark doubles, taps length 512, input len 100000, output len 200000", "[interpolate],[double],[polyphase]")
+{
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    std::vector<double> taps(512);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps);
+
+    double T = 0.01;
+    std::vector<double> t(200000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T/2;
+
+    std::vector<std::complex<double>> out(200000);
+
+    BENCHMARK("up 16, 1 thread")
+    {
+        upfirlerp.set_up_rate(16).set_threads(1);
+
+        upfirlerp.interpolate(
+            input, T, t, out
+        );
+    };
+
+    BENCHMARK("up 64, 1 thread")
+    {
+        upfirlerp.set_up_rate(64).set_threads(1);
+
+        upfirlerp.interpolate(
+            input, T, t, out
+        );
+    };
+}
+
+
+
+// Short blocks called back to back, where per-call overhead dominates.
+// Workers are persistent, so this should be compared against spawning threads every call.
+TEST_CASE("benchmark doubles, taps length 100, input len 1000, output len 1000", "[interpolate],[double],[latency]")
+{
+    std::vector<std::complex<double>> input(1000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    std::vector<double> taps(100);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    double T = 0.01;
+    std::vector<double> t(1000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T;
+
+    std::vector<std::complex<double>> out(1000);
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(10);
+
+    BENCHMARK("up 10, 1 thread")
+    {
+        upfirlerp.set_threads(1);
+
+        upfirlerp.interpolate(
+            input, T, t, out
+        );
+    };
+
+    BENCHMARK("up 10, 4 threads")
+    {
+        upfirlerp.set_threads(4);
+
+        upfirlerp.interpolate(
+            input, T, t, out
+        );
+    };
+
+    // Reference: what every call used to cost, spawning and joining fresh threads.
+    // An interpolator is not reentrant, so each spawned thread gets one of its own
+    ufl::UpfirLerp<double> singles[4];
+    for (auto& single : singles)
+        single.set_up_taps(taps).set_up_rate(10).set_threads(1);
+
+    BENCHMARK("up 10, 4 threads spawned per call")
+    {
+        std::thread threads[4];
+        for (int tidx = 0; tidx < 4; tidx++)
+        {
+            threads[tidx] = std::thread([&, tidx]{
+                size_t start = tidx * t.size() / 4;
+                size_t stop = (tidx + 1) * t.size() / 4;
+                singles[tidx].interpolate_array(
+                    input.data(), input.size(), T,
+                    t.data() + start, stop - start,
+                    out.data() + start
+                );
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    };
+}
+
+
+
+// Vectorised dot product kernels against the scalar fallback, on a long filter
+TEST_CASE("benchmark simd kernels, taps length 512, input len 100000, output len 200000", "[interpolate],[simd]")
+{
+    std::vector<double> taps(512);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+    std::vector<float> taps_f(taps.begin(), taps.end());
+
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+    std::vector<std::complex<float>> input_f(input.begin(), input.end());
+
+    double T = 0.01;
+    std::vector<double> t(200000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T/2;
+
+    std::vector<std::complex<double>> out(200000);
+    std::vector<std::complex<float>> out_f(200000);
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(8);
+    ufl::UpfirLerp<float> upfirlerp_f;
+    upfirlerp_f.set_up_taps(taps_f).set_up_rate(8);
+    const ufl::simd::Isa best = upfirlerp.get_isa();
+
+    BENCHMARK("double, up 8, scalar")
+    {
+        upfirlerp.set_isa(ufl::simd::Isa::Scalar);
+        upfirlerp.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK("double, up 8, best simd")
+    {
+        upfirlerp.set_isa(best);
+        upfirlerp.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK("float, up 8, scalar")
+    {
+        upfirlerp_f.set_isa(ufl::simd::Isa::Scalar);
+        upfirlerp_f.interpolate(input_f, T, t, out_f);
+    };
+
+    BENCHMARK("float, up 8, best simd")
+    {
+        upfirlerp_f.set_isa(best);
+        upfirlerp_f.interpolate(input_f, T, t, out_f);
+    };
+
+    // Short filters around the cut-over to the scalar kernels, below min_vector_taps taps per sub-filter,
+    // where both rows should match; the 3-tap filter is run without upsampling
+    for (auto shape : {std::make_pair(3, 1), std::make_pair(4, 8), std::make_pair(8, 8), std::make_pair(16, 8)})
+    {
+        const int phase_taps = shape.first, up = shape.second;
+        std::vector<float> short_taps(taps_f.begin(), taps_f.begin() + phase_taps * up);
+        ufl::UpfirLerp<float> scalar, simd;
+        scalar.set_up_taps(short_taps, ufl::Symmetry::None).set_up_rate(up).set_isa(ufl::simd::Isa::Scalar);
+        simd.set_up_taps(short_taps, ufl::Symmetry::None).set_up_rate(up).set_isa(best);
+
+        const std::string name = "float, " + std::to_string(phase_taps * up) + " taps, up " + std::to_string(up);
+        BENCHMARK(name + ", scalar")
+        {
+            scalar.interpolate(input_f, T, t, out_f);
+        };
+
+        BENCHMARK(name + ", best simd")
+        {
+            simd.interpolate(input_f, T, t, out_f);
+        };
+    }
+}
+
+
+
+// Linear-phase taps, as firwin designs them, folded against the same taps multiplied out.
+// 257 taps: without upsampling, or at an upsample rate of 2, every sub-filter mirrors itself and
+// needs 129 multiplies instead of 257 (or 65 instead of 129); at 4 only half of the phases do.
+TEST_CASE("benchmark symmetric taps, taps length 257, input len 100000, output len 200000", "[interpolate],[symmetry]")
+{
+    // Hamming-windowed sinc, cutoff at a quarter of the input rate
+    std::vector<double> taps(257);
+    for (int k = 0; k < 257; k++)
+    {
+        const double m = k - 128.0;
+        const double sinc = m == 0 ? 0.5 : std::sin(M_PI * 0.5 * m) / (M_PI * m);
+        taps[k] = sinc * (0.54 - 0.46 * std::cos(2 * M_PI * k / 256.0));
+    }
+    std::vector<float> taps_f(taps.begin(), taps.end());
+
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+    std::vector<std::complex<float>> input_f(input.begin(), input.end());
+
+    double T = 0.01;
+    std::vector<double> t(200000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T/2.1;
+
+    std::vector<std::complex<double>> out(200000);
+    std::vector<std::complex<float>> out_f(200000);
+
+    // Dot products only, which is what folds
+    ufl::UpfirLerp<double> folded, plain;
+    ufl::UpfirLerp<float> folded_f, plain_f;
+    folded.set_fft_crossover(0);
+    plain.set_fft_crossover(0);
+    folded_f.set_fft_crossover(0);
+    plain_f.set_fft_crossover(0);
+
+    for (int up : {1, 2, 4})
+    {
+        folded.set_up_rate(up).set_up_taps(taps);
+        plain.set_up_rate(up).set_up_taps(taps, ufl::Symmetry::None);
+        folded_f.set_up_rate(up).set_up_taps(taps_f);
+        plain_f.set_up_rate(up).set_up_taps(taps_f, ufl::Symmetry::None);
+
+        BENCHMARK("double, up " + std::to_string(up) + ", unfolded")
+        {
+            plain.interpolate(input, T, t, out);
+        };
+
+        BENCHMARK("double, up " + std::to_string(up) + ", folded")
+        {
+            folded.interpolate(input, T, t, out);
+        };
+
+        BENCHMARK("float, up " + std::to_string(up) + ", unfolded")
+        {
+            plain_f.interpolate(input_f, T, t, out_f);
+        };
+
+        BENCHMARK("float, up " + std::to_string(up) + ", folded")
+        {
+            folded_f.interpolate(input_f, T, t, out_f);
+        };
+    }
+
+    folded.set_up_rate(2).set_up_taps(taps).set_isa(ufl::simd::Isa::Scalar);
+    plain.set_up_rate(2).set_up_taps(taps, ufl::Symmetry::None).set_isa(ufl::simd::Isa::Scalar);
+
+    BENCHMARK("double, up 2, scalar, unfolded")
+    {
+        plain.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK("double, up 2, scalar, folded")
+    {
+        folded.interpolate(input, T, t, out);
+    };
+}
+
+
+
+// Dense sorted outputs, several per interrim sample,
+// where carrying interrim samples between outputs saves most of the dot products
+TEST_CASE("benchmark sorted time, taps length 256, input len 100000, output len 400000", "[interpolate],[sorted]")
+{
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    std::vector<double> taps(256);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    // Dot products only, so the carry is what is compared
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(4).set_fft_crossover(0);
+
+    double T = 0.01;
+    std::vector<double> t(400000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T/4.5;
+
+    std::vector<std::complex<double>> out(400000);
+
+    BENCHMARK("up 4, 1 thread, per-point")
+    {
+        upfirlerp.set_time_order(ufl::TimeOrder::Unsorted);
+        upfirlerp.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK("up 4, 1 thread, sorted")
+    {
+        upfirlerp.set_time_order(ufl::TimeOrder::Sorted);
+        upfirlerp.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK("up 4, 1 thread, auto-detected")
+    {
+        upfirlerp.set_time_order(ufl::TimeOrder::Auto);
+        upfirlerp.interpolate(input, T, t, out);
+    };
+
+    // The same times as exact positions in input samples
+    std::vector<ufl::FixedTime> positions(t.size());
+    for (int i = 0; i < t.size(); ++i)
+        positions[i] = ufl::FixedTime::from_double(t[i] / T);
+
+    BENCHMARK("up 4, 1 thread, fixed-point times")
+    {
+        upfirlerp.interpolate(input, positions, out);
+    };
+}
+
+
+
+// Same grid as the cases above, passed as (t0, dt, N) instead of a time vector
+TEST_CASE("benchmark uniform grid, taps length 100, input len 100000, output len 200000", "[interpolate],[uniform]")
+{
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    std::vector<double> taps(100);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(10);
+
+    double T = 0.01;
+    std::vector<double> t(200000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T/100;
+
+    std::vector<std::complex<double>> out(200000);
+
+    BENCHMARK("up 10, 1 thread, time vector")
+    {
+        upfirlerp.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK("up 10, 1 thread, uniform grid")
+    {
+        upfirlerp.interpolate_uniform(input, T, 0.0, T/100, t.size(), out);
+    };
+}
+
+
+
+// An antenna array resampled at one shared t, one call per channel against the batched layouts
+TEST_CASE("benchmark 16 channels, taps length 100, input len 10000, output len 20000", "[interpolate],[channels]")
+{
+    const size_t channels = 16;
+    const size_t in_length = 10000;
+
+    std::vector<std::complex<double>> input(in_length * channels);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    std::vector<double> taps(100);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(10).set_threads(4);
+
+    double T = 0.01;
+    std::vector<double> t(20000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T/2;
+
+    // Channel-major rows, and the same data interleaved
+    std::vector<std::complex<double>> interleaved(input.size());
+    for (size_t k = 0; k < in_length; k++)
+        for (size_t c = 0; c < channels; c++)
+            interleaved[k * channels + c] = input[c * in_length + k];
+
+    std::vector<std::complex<double>> out(t.size() * channels);
+    std::vector<const std::complex<double>*> in_rows(channels);
+    std::vector<std::complex<double>*> out_rows(channels);
+    for (size_t c = 0; c < channels; c++)
+    {
+        in_rows[c] = input.data() + c * in_length;
+        out_rows[c] = out.data() + c * t.size();
+    }
+
+    BENCHMARK("up 10, 4 threads, one call per channel")
+    {
+        for (size_t c = 0; c < channels; c++)
+            upfirlerp.interpolate_array(in_rows[c], in_length, T, t.data(), t.size(), out_rows[c]);
+    };
+
+    BENCHMARK("up 10, 4 threads, channel-major batch")
+    {
+        upfirlerp.interpolate_channels(in_rows.data(), channels, in_length, T, t.data(), t.size(), out_rows.data());
+    };
+
+    BENCHMARK("up 10, 4 threads, interleaved batch")
+    {
+        upfirlerp.interpolate_interleaved(interleaved.data(), channels, in_length, T, t.data(), t.size(), out.data());
+    };
+}
+
+
+
+// Per-point against block evaluation over sparse, dense and clustered unsorted t,
+// to check where the density crossover of the Auto strategy should sit
+TEST_CASE("benchmark strategies, taps length 128, input len 100000", "[interpolate],[strategy]")
+{
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    std::vector<double> taps(128);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(8);
+
+    double T = 0.01;
+    const double duration = T * input.size();
+    auto uniform_random = [&](size_t n) {
+        std::vector<double> t(n);
+        for (auto& v : t)
+            v = std::rand() / (double)RAND_MAX * duration;
+        return t;
+    };
+
+    // 0.02 outputs per interrim sample
+    std::vector<double> sparse = uniform_random(16000);
+    // 2 outputs per interrim sample
+    std::vector<double> dense = uniform_random(1600000);
+    // 50 clusters of 4000 outputs, each spanning 100 input samples
+    std::vector<double> clustered(200000);
+    for (size_t c = 0; c < 50; c++)
+    {
+        double centre = std::rand() / (double)RAND_MAX * (duration - 100 * T);
+        for (size_t k = 0; k < 4000; k++)
+            clustered[c * 4000 + k] = centre + std::rand() / (double)RAND_MAX * 100 * T;
+    }
+    for (size_t i = clustered.size() - 1; i > 0; i--)
+        std::swap(clustered[i], clustered[std::rand() % (i + 1)]);
+
+    std::vector<std::complex<double>> out;
+
+    const std::pair<const char*, std::vector<double>*> patterns[] = {
+        {"sparse", &sparse}, {"dense", &dense}, {"clustered", &clustered}
+    };
+    for (auto& pattern : patterns)
+    {
+        std::string name = pattern.first;
+        std::vector<double>& t = *pattern.second;
+
+        BENCHMARK(name + ", per-point")
+        {
+            upfirlerp.set_strategy(ufl::Strategy::PerPoint);
+            upfirlerp.interpolate(input, T, t, out);
+        };
+
+        BENCHMARK(name + ", block")
+        {
+            upfirlerp.set_strategy(ufl::Strategy::Block);
+            upfirlerp.interpolate(input, T, t, out);
+        };
+
+        BENCHMARK(name + ", auto")
+        {
+            upfirlerp.set_strategy(ufl::Strategy::Auto);
+            upfirlerp.interpolate(input, T, t, out);
+        };
+    }
+}
+
+
+// Randomly ordered times over a capture far larger than the cache, as in Monte Carlo sampling.
+// Per-point fetches every output's input window from memory; reordering sorts each thread's outputs
+// by interrim index first and sweeps the input once. The same times sorted are the floor.
+TEST_CASE("benchmark shuffled time, taps length 64, input len 10000000, output len 2000000", "[interpolate],[reorder]")
+{
+    std::vector<float> taps(64);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (float)RAND_MAX;
+    }
+
+    std::vector<std::complex<float>> input(10000000);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+
+    ufl::UpfirLerp<float> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(4);
+
+    double T = 0.01;
+    std::vector<double> shuffled(2000000);
+    for (auto& v : shuffled)
+        v = std::rand() / (double)RAND_MAX * T * (input.size() - 1);
+    std::vector<double> sorted = shuffled;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<std::complex<float>> out(shuffled.size());
+
+    BENCHMARK("shuffled, per-point")
+    {
+        upfirlerp.set_strategy(ufl::Strategy::PerPoint);
+        upfirlerp.interpolate(input, T, shuffled, out);
+    };
+
+    BENCHMARK("shuffled, auto")
+    {
+        upfirlerp.set_strategy(ufl::Strategy::Auto);
+        upfirlerp.interpolate(input, T, shuffled, out);
+    };
+
+    BENCHMARK("shuffled, reorder")
+    {
+        upfirlerp.set_strategy(ufl::Strategy::Reorder);
+        upfirlerp.interpolate(input, T, shuffled, out);
+    };
+
+    BENCHMARK("sorted, per-point")
+    {
+        upfirlerp.set_strategy(ufl::Strategy::PerPoint);
+        upfirlerp.interpolate(input, T, sorted, out);
+    };
+}
+
+
+// Raw 16-bit and 8-bit IQ read directly, against converting the capture to complex floats first
+TEST_CASE("benchmark integer IQ input, taps length 64, input len 2000000, output len 2000000", "[interpolate],[iq]")
+{
+    std::vector<float> taps(64);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (float)RAND_MAX;
+    }
+
+    std::vector<std::complex<int16_t>> input16(2000000);
+    for (auto& v : input16)
+        v = std::complex<int16_t>(static_cast<int16_t>(std::rand()), static_cast<int16_t>(std::rand()));
+    std::vector<std::complex<int8_t>> input8(input16.size());
+    for (size_t i = 0; i < input8.size(); ++i)
+        input8[i] = std::complex<int8_t>(static_cast<int8_t>(input16[i].real() >> 8), static_cast<int8_t>(input16[i].imag() >> 8));
+    std::vector<std::complex<float>> converted(input16.size());
+
+    double T = 0.01;
+    std::vector<double> t(2000000);
+    for (int i = 0; i < t.size(); ++i)
+        t.at(i) = i * T;
+
+    std::vector<std::complex<float>> out(t.size());
+
+    ufl::UpfirLerp<float> upfirlerp_f;
+    upfirlerp_f.set_up_taps(taps).set_up_rate(8).set_input_scale(1.0f / 32768);
+    ufl::UpfirLerp<float, int16_t> upfirlerp_16;
+    upfirlerp_16.set_up_taps(taps).set_up_rate(8).set_input_scale(1.0f / 32768);
+    ufl::UpfirLerp<float, int8_t> upfirlerp_8;
+    upfirlerp_8.set_up_taps(taps).set_up_rate(8).set_input_scale(1.0f / 128);
+
+    BENCHMARK("int16, converted to float first")
+    {
+        for (size_t i = 0; i < input16.size(); ++i)
+            converted[i] = std::complex<float>(input16[i].real(), input16[i].imag());
+        upfirlerp_f.interpolate(converted, T, t, out);
+    };
+
+    BENCHMARK("int16, read directly")
+    {
+        upfirlerp_16.interpolate(input16, T, t, out);
+    };
+
+    BENCHMARK("int8, read directly")
+    {
+        upfirlerp_8.interpolate(input8, T, t, out);
+    };
+}
+
+
+// Fixed specialisations against the generic path for the same filter shapes
+template <int NTAPS, int UP>
+static void benchmark_fixed_config()
+{
+    std::vector<float> taps(NTAPS);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (float)RAND_MAX;
+    }
+
+    std::vector<std::complex<float>> input(100000);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+
+    double T = 0.01;
+    std::vector<double> t(200000);
+    for (auto& v : t)
+        v = std::rand() / (double)RAND_MAX * T * input.size();
+
+    std::vector<std::complex<float>> out;
+
+    ufl::UpfirLerp<float> generic;
+    generic.set_up_taps(taps).set_up_rate(UP);
+    ufl::UpfirLerpFixed<float, NTAPS, UP> fixed;
+    fixed.set_up_taps(taps);
+    auto registered = ufl::make_upfirlerp<float>(taps, UP);
+
+    const std::string name = std::to_string(NTAPS) + " taps, up " + std::to_string(UP);
+
+    BENCHMARK(name + ", generic")
+    {
+        generic.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK(name + ", fixed")
+    {
+        fixed.interpolate(input, T, t, out);
+    };
+
+    BENCHMARK(name + ", via registry")
+    {
+        registered->interpolate(input, T, t, out);
+    };
+}
+
+TEST_CASE("benchmark fixed specialisations, input len 100000, output len 200000", "[interpolate],[fixed]")
+{
+    benchmark_fixed_config<64, 8>();
+    benchmark_fixed_config<128, 16>();
+}
+
+
+// Skewed time vectors, where an equal split of the outputs is far from an equal split of the work;
+// compare each against the single-threaded time for the scaling
+TEST_CASE("benchmark skewed time scheduling, taps length 100, input len 100000, output len 400000", "[interpolate],[schedule]")
+{
+    std::vector<double> taps(100);
+    for (auto& v : taps)
+    {
+        v = std::rand() / (double)RAND_MAX;
+    }
+
+    std::vector<std::complex<double>> input(100000);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+
+    double T = 0.01;
+    const double duration = T * input.size();
+
+    // Sorted, with the outputs bunched up at the start, so the last slices are mostly sparse
+    std::vector<double> bunched(400000);
+    for (int i = 0; i < bunched.size(); ++i)
+    {
+        double x = i / (double)bunched.size();
+        bunched[i] = x * x * x * x * duration;
+    }
+    // Unsorted, with the first 60% out of range
+    std::vector<double> partial(400000);
+    for (int i = 0; i < partial.size(); ++i)
+        partial[i] = i < partial.size() * 6 / 10 ? -1.0 : std::rand() / (double)RAND_MAX * duration;
+
+    std::vector<std::complex<double>> out;
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(10).set_strategy(ufl::Strategy::PerPoint);
+
+    const std::pair<const char*, std::vector<double>*> patterns[] = {
+        {"bunched sorted", &bunched}, {"partly out of range", &partial}
+    };
+    for (auto& pattern : patterns)
+    {
+        std::string name = pattern.first;
+        std::vector<double>& t = *pattern.second;
+
+        BENCHMARK(name + ", 1 thread")
+        {
+            upfirlerp.set_threads(1);
+            upfirlerp.interpolate(input, T, t, out);
+        };
+
+        BENCHMARK(name + ", 4 threads, static")
+        {
+            upfirlerp.set_threads(4).set_schedule(ufl::Schedule::Static);
+            upfirlerp.interpolate(input, T, t, out);
+        };
+
+        BENCHMARK(name + ", 4 threads, dynamic")
+        {
+            upfirlerp.set_threads(4).set_schedule(ufl::Schedule::Dynamic);
+            upfirlerp.interpolate(input, T, t, out);
+        };
+    }
+}
+
+TEST_CASE("benchmark delay hypotheses, taps length 128, input len 100000, output len 50000, 32 offsets", "[interpolate],[hypotheses]")
+{
+    std::vector<float> taps(128);
+    for (auto& v : taps)
+        v = std::rand() / (float)RAND_MAX;
+
+    std::vector<std::complex<float>> input(100000);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+
+    double T = 0.01;
+    std::vector<double> t(50000);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = (i + 0.5) * 1.9 * T;
+
+    // Fine candidate delays within +-1/4 input sample, a few per interrim sample
+    std::vector<double> offsets(32);
+    for (int k = 0; k < offsets.size(); ++k)
+        offsets[k] = (k - 16) * T / 64;
+
+    std::vector<std::vector<double>> shifted(offsets.size(), t);
+    for (int k = 0; k < offsets.size(); ++k)
+        for (auto& v : shifted[k])
+            v += offsets[k];
+
+    std::vector<std::complex<float>> out;
+
+    ufl::UpfirLerp<float> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(16);
+
+    BENCHMARK("up 16, 1 thread, one call per offset")
+    {
+        for (auto& tk : shifted)
+            upfirlerp.interpolate(input, T, tk, out);
+    };
+
+    BENCHMARK("up 16, 1 thread, shared offsets")
+    {
+        upfirlerp.interpolate_offsets(input, T, t, offsets, out);
+    };
+}
+
+TEST_CASE("benchmark refinement iterations, taps length 512, input len 1000000, 5000 times", "[interpolate],[cache]")
+{
+    std::vector<float> taps(512);
+    for (auto& v : taps)
+        v = std::rand() / (float)RAND_MAX;
+
+    std::vector<std::complex<float>> input(1000000);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+
+    double T = 0.01;
+    std::vector<double> t(5000);
+    for (auto& v : t)
+        v = std::rand() / (double)RAND_MAX * T * (input.size() - 1);
+
+    // Each iteration nudges every time by a fraction of an interrim sample, as a timing refinement would
+    const int iterations = 20;
+    std::vector<std::vector<double>> steps(iterations, t);
+    for (int it = 0; it < iterations; ++it)
+        for (auto& v : steps[it])
+            v += (it % 5 - 2) * T / 8 * 0.05;
+
+    std::vector<std::complex<float>> out;
+
+    ufl::UpfirLerp<float> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(8);
+
+    BENCHMARK("up 8, 20 iterations, uncached")
+    {
+        for (auto& ti : steps)
+            upfirlerp.interpolate(input, T, ti, out);
+    };
+
+    // Configured once, as a search loop would; the invalidation keeps the first, cold iteration in the timing
+    ufl::UpfirLerp<float> cached;
+    cached.set_up_taps(taps).set_up_rate(8).set_interrim_cache(8192);
+
+    BENCHMARK("up 8, 20 iterations, cached")
+    {
+        cached.invalidate_interrim_cache();
+        for (auto& ti : steps)
+            cached.interpolate(input, T, ti, out);
+    };
+}
+
+TEST_CASE("benchmark fused epilogue, taps length 32, input len 1000000, output len 4000000", "[interpolate],[epilogue]")
+{
+    std::vector<float> taps(32);
+    for (auto& v : taps)
+        v = std::rand() / (float)RAND_MAX;
+
+    std::vector<std::complex<float>> input(1000000);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+
+    ufl::UpfirLerp<float> upfirlerp;
+    upfirlerp.set_up_taps(taps).set_up_rate(4);
+
+    // Mix down, scale, add into a running sum and correlate against a template
+    double T = 0.01;
+    const double dt = T / 4.1;
+    const size_t N = 4000000;
+    std::vector<std::complex<float>> reference(N, std::complex<float>(0.5f, -0.5f));
+    std::vector<std::complex<float>> out(N), sum(N);
+
+    ufl::FusedOps<float> ops;
+    ops.set_gain(0.5f).set_mixer(12.5, 0.1).set_accumulate(true).set_reference(reference.data());
+
+    BENCHMARK("up 4, 1 thread, separate pass")
+    {
+        upfirlerp.interpolate_uniform_array(input.data(), input.size(), T, 0.0, dt, N, out.data());
+        ops.grid(0.0, dt);
+        for (size_t k = 0; k < N; k += ufl::epilogue_tile)
+            ops(k, std::min(ufl::epilogue_tile, N - k), nullptr, out.data() + k, sum.data() + k);
+        return ops.get_dot();
+    };
+
+    BENCHMARK("up 4, 1 thread, fused")
+    {
+        upfirlerp.interpolate_uniform_array(input.data(), input.size(), T, 0.0, dt, N, sum.data(), ops);
+        return ops.get_dot();
+    };
+}
+
+
+
+// Dot products against the overlap-save engine over sub-filter lengths, on a uniform grid with one output
+// per interrim sample and on one with an output every 4; the default FFT crossover is where overlap-save wins both
+TEST_CASE("benchmark fft crossover, up 16, input len 50000", "[interpolate],[fft]")
+{
+    std::vector<std::complex<float>> input(50000);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+
+    const int up = 16;
+    const double T = 0.01;
+    std::vector<std::complex<float>> out(input.size() * up);
+
+    for (int phase_taps : {16, 32, 64, 128, 256, 512})
+    {
+        std::vector<float> taps(phase_taps * up);
+        for (auto& v : taps)
+            v = std::rand() / (float)RAND_MAX;
+
+        ufl::UpfirLerp<float> dot, fft;
+        dot.set_up_rate(up).set_up_taps(taps, ufl::Symmetry::None).set_fft_crossover(0);
+        fft.set_up_rate(up).set_up_taps(taps, ufl::Symmetry::None).set_fft_crossover(1);
+
+        for (int every : {1, 4})
+        {
+            const std::string name = std::to_string(phase_taps) + " taps per phase, output every " + std::to_string(every);
+            const double dt = every * T / up;
+            const size_t n = out.size() / every;
+
+            BENCHMARK(name + ", dot products")
+            {
+                dot.interpolate_uniform_array(input.data(), input.size(), T, 0, dt, n, out.data());
+            };
+
+            BENCHMARK(name + ", overlap-save")
+            {
+                fft.interpolate_uniform_array(input.data(), input.size(), T, 0, dt, n, out.data());
+            };
+        }
+    }
+}
+
+
+
+// Small real-time blocks, where a call's fixed costs weigh most: the throwing call, with workspaces grown
+// on demand, against the noexcept span entry point after reserve()
+TEST_CASE("benchmark reserved span calls, up 8, 1024 outputs", "[interpolate],[realtime]")
+{
+    std::vector<std::complex<float>> input(512);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+    std::vector<float> taps(64);
+    for (auto& v : taps)
+        v = std::rand() / (float)RAND_MAX;
+
+    const double T = 1.0;
+    std::vector<double> t(1024);
+    for (auto& v : t)
+        v = std::rand() / (double)RAND_MAX * (input.size() - 1);
+    std::vector<std::complex<float>> out(t.size());
+
+    for (auto strategy : {ufl::Strategy::Auto, ufl::Strategy::Reorder})
+    {
+        const std::string name = strategy == ufl::Strategy::Auto ? "auto" : "reorder";
+
+        ufl::UpfirLerp<float> grown;
+        grown.set_up_rate(8).set_up_taps(taps).set_strategy(strategy);
+        BENCHMARK(name + ", interpolate_array")
+        {
+            grown.interpolate_array(input.data(), input.size(), T, t.data(), t.size(), out.data());
+        };
+
+        ufl::UpfirLerp<float> reserved;
+        reserved.set_up_rate(8).set_up_taps(taps).set_strategy(strategy).reserve(out.size());
+        BENCHMARK(name + ", reserved interpolate_into")
+        {
+            return reserved.interpolate_into(input, T, t, out);
+        };
+    }
+}
+
+
+
+// Sustained throughput of a capture-like pipeline: each block is read in (a scaled copy of a source buffer),
+// resampled, and reduced downstream to its power. Back-to-back synchronous calls run the three stages in turn;
+// the async queue with triple buffering overlaps them, so the sum approaches the slowest stage given free cores
+TEST_CASE("benchmark async pipeline, up 4, 16 blocks of 65536 outputs", "[interpolate],[async]")
+{
+    const size_t blocks = 16, block_len = 16384, outputs = 65536;
+    const double T = 1.0;
+
+    std::vector<std::complex<float>> source(block_len * blocks);
+    for (auto& v : source)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+    std::vector<float> taps(64);
+    for (auto& v : taps)
+        v = std::rand() / (float)RAND_MAX;
+    std::vector<double> t(outputs);
+    for (size_t i = 0; i < outputs; i++)
+        t[i] = i * (block_len - 1) * T / outputs;
+
+    auto read = [&](size_t b, std::vector<std::complex<float>>& in) {
+        for (size_t i = 0; i < block_len; i++)
+            in[i] = source[b * block_len + i] * 0.5f;
+    };
+    auto consume = [](const std::vector<std::complex<float>>& out) {
+        float power = 0;
+        for (auto& v : out)
+            power += std::norm(v);
+        return power;
+    };
+
+    ufl::UpfirLerp<float> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(taps).reserve(outputs);
+
+    BENCHMARK("back-to-back synchronous calls")
+    {
+        std::vector<std::complex<float>> in(block_len), out(outputs);
+        float total = 0;
+        for (size_t b = 0; b < blocks; b++)
+        {
+            read(b, in);
+            upfirlerp.interpolate_array(in.data(), block_len, T, t.data(), outputs, out.data());
+            total += consume(out);
+        }
+        return total;
+    };
+
+    struct Slot
+    {
+        std::vector<std::complex<float>> in;
+        std::vector<std::complex<float>> out;
+    };
+    ufl::BufferRing<Slot> ring(3);
+    for (size_t s = 0; s < ring.size(); s++)
+    {
+        ring[s].in.resize(block_len);
+        ring[s].out.resize(outputs);
+    }
+
+    BENCHMARK("async queue, triple buffered")
+    {
+        float total = 0;
+        ufl::AsyncQueue<ufl::UpfirLerp<float>> queue(upfirlerp);
+        for (size_t b = 0; b < blocks; b++)
+        {
+            Slot& slot = ring.acquire();
+            read(b, slot.in);
+            ring.release(queue.submit(slot.in.data(), block_len, T, t.data(), outputs, slot.out.data(),
+                                      [&total, &slot, &consume]{ total += consume(slot.out); }));
+        }
+        ring.drain();
+        return total;
+    };
+}
@@ -0,0 +1,352 @@
+// Parameter sweep over element type, filter shape, lengths, threads and time patterns.
+// Reports throughput per configuration and can write JSON/CSV for comparison across commits,
+// or check a run against a stored CSV baseline and fail on a throughput drop.
+//
+// Usage: sweep [options]
+//   --types float,double        element types
+//   --taps 8,32,128,512,1024    tap lengths
+//   --up 2,8,32                 upsample rates
+//   --in 100000                 input lengths
+//   --out 200000                output lengths
+//   --threads 1,4               thread counts
+//   --patterns uniform,sorted,unsorted,clustered,outofrange
+//   --reps 5                    timed repetitions per configuration, the median is reported
+//   --quick                     a small sweep, for smoke tests
+//   --json FILE, --csv FILE     write results
+//   --baseline FILE             CSV from an earlier --csv run to compare against
+//   --threshold 0.1             allowed fractional drop in Msamples/s before the check fails
+//
+// Exits with 1 on a regression, and with 2 on bad arguments, an unreadable baseline,
+// or a baseline that shares no configuration with the sweep.
+
+#include "upfirlerp.h"
+#include <vector>
+#include <complex>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+struct Config
+{
+    std::string type;
+    int taps;
+    int up;
+    size_t in_length;
+    size_t out_length;
+    int threads;
+    std::string pattern;
+
+    std::string key() const
+    {
+        std::ostringstream ss;
+        ss << type << "," << taps << "," << up << "," << in_length << ","
+           << out_length << "," << threads << "," << pattern;
+        return ss.str();
+    }
+};
+
+struct Result
+{
+    Config config;
+    double seconds;
+    double msamples_per_s;  // outputs requested per second
+    double gmacs_per_s;     // nominal real-by-complex MACs, 2 interrim samples of taps/up each per valid output
+    double gbytes_per_s;    // input, time vector and output moved once per call
+};
+
+static std::vector<std::string> split(const std::string& s)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ','))
+        if (!part.empty())
+            parts.push_back(part);
+    return parts;
+}
+
+template <typename N>
+static std::vector<N> split_numbers(const std::string& s)
+{
+    std::vector<N> values;
+    for (auto& part : split(s))
+        values.push_back(static_cast<N>(std::stoll(part)));
+    return values;
+}
+
+static const std::set<std::string> known_types = {"float", "double"};
+static const std::set<std::string> known_patterns = {"uniform", "sorted", "unsorted", "clustered", "outofrange"};
+
+// Output times for a named pattern, over an input of duration T * in_length
+static std::vector<double> make_times(const std::string& pattern, size_t out_length, size_t in_length, double T)
+{
+    const double duration = T * in_length;
+    auto uniform_random = [&]{ return std::rand() / (double)RAND_MAX * duration; };
+
+    std::vector<double> t(out_length);
+    if (pattern == "uniform")
+    {
+        for (size_t i = 0; i < out_length; i++)
+            t[i] = i * duration / out_length;
+    }
+    else if (pattern == "sorted" || pattern == "unsorted")
+    {
+        for (auto& v : t)
+            v = uniform_random();
+        if (pattern == "sorted")
+            std::sort(t.begin(), t.end());
+    }
+    else if (pattern == "clustered")
+    {
+        // 50 clusters, each spanning 100 input samples, visited in random order
+        const size_t clusters = 50;
+        for (size_t c = 0; c < clusters; c++)
+        {
+            double centre = std::rand() / (double)RAND_MAX * (duration - 100 * T);
+            for (size_t k = c * out_length / clusters; k < (c + 1) * out_length / clusters; k++)
+                t[k] = centre + std::rand() / (double)RAND_MAX * 100 * T;
+        }
+        for (size_t i = out_length; i > 1; i--)
+            std::swap(t[i - 1], t[std::rand() % i]);
+    }
+    else if (pattern == "outofrange")
+    {
+        // 90% of the outputs fall outside the signal
+        for (auto& v : t)
+            v = std::rand() % 10 == 0 ? uniform_random() : -1.0 - uniform_random();
+    }
+    else
+    {
+        throw std::invalid_argument("unknown t pattern: " + pattern);
+    }
+    return t;
+}
+
+template <typename T>
+static Result run_config(const Config& config, int reps)
+{
+    const double in_T = 0.01;
+
+    std::vector<T> taps(config.taps);
+    for (auto& v : taps)
+        v = std::rand() / (T)RAND_MAX;
+    std::vector<std::complex<T>> input(config.in_length);
+    for (auto& v : input)
+        v = std::complex<T>(std::rand() / (T)RAND_MAX, std::rand() / (T)RAND_MAX);
+    std::vector<double> t = make_times(config.pattern, config.out_length, config.in_length, in_T);
+    std::vector<std::complex<T>> out(config.out_length);
+
+    ufl::UpfirLerp<T> upfirlerp;
+    upfirlerp.set_up_rate(config.up).set_up_taps(taps).set_threads(config.threads);
+
+    // One untimed call to warm up the pool and the caches
+    upfirlerp.interpolate_array(input.data(), input.size(), in_T, t.data(), t.size(), out.data());
+
+    std::vector<double> times;
+    for (int r = 0; r < reps; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        upfirlerp.interpolate_array(input.data(), input.size(), in_T, t.data(), t.size(), out.data());
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+
+    const double t_max = in_T / config.up * (config.in_length * config.up - 1);
+    size_t valid = 0;
+    for (double ti : t)
+        valid += ti >= 0 && ti <= t_max;
+
+    Result result;
+    result.config = config;
+    result.seconds = times[times.size() / 2];
+    const double phase_len = static_cast<double>((config.taps + config.up - 1) / config.up);
+    const double bytes = sizeof(std::complex<T>) * (config.in_length + config.out_length) + sizeof(double) * config.out_length;
+    result.msamples_per_s = config.out_length / result.seconds * 1e-6;
+    result.gmacs_per_s = valid * 2 * phase_len / result.seconds * 1e-9;
+    result.gbytes_per_s = bytes / result.seconds * 1e-9;
+    return result;
+}
+
+static void write_csv(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream f(path);
+    f << "type,taps,up,in_length,out_length,threads,pattern,seconds,msamples_per_s,gmacs_per_s,gbytes_per_s\n";
+    for (auto& r : results)
+        f << r.config.key() << "," << r.seconds << "," << r.msamples_per_s << ","
+          << r.gmacs_per_s << "," << r.gbytes_per_s << "\n";
+}
+
+static void write_json(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream f(path);
+    f << "[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        f << "  {\"type\": \"" << r.config.type << "\", \"taps\": " << r.config.taps
+          << ", \"up\": " << r.config.up << ", \"in_length\": " << r.config.in_length
+          << ", \"out_length\": " << r.config.out_length << ", \"threads\": " << r.config.threads
+          << ", \"pattern\": \"" << r.config.pattern << "\", \"seconds\": " << r.seconds
+          << ", \"msamples_per_s\": " << r.msamples_per_s << ", \"gmacs_per_s\": " << r.gmacs_per_s
+          << ", \"gbytes_per_s\": " << r.gbytes_per_s << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    f << "]\n";
+}
+
+// Msamples/s per configuration key from a CSV written by write_csv()
+static std::map<std::string, double> read_baseline(const std::string& path)
+{
+    std::ifstream f(path);
+    if (!f)
+        throw std::runtime_error("cannot open baseline " + path);
+
+    std::map<std::string, double> baseline;
+    std::string line;
+    std::getline(f, line); // header
+    while (std::getline(f, line))
+    {
+        auto fields = split(line);
+        if (fields.size() < 9)
+            continue;
+
+        std::string key = fields[0];
+        for (int i = 1; i < 7; i++)
+            key += "," + fields[i];
+        baseline[key] = std::stod(fields[8]);
+    }
+    return baseline;
+}
+
+static int run(int argc, char* argv[])
+{
+    std::map<std::string, std::string> args = {
+        {"types", "float,double"},
+        {"taps", "8,32,128,512,1024"},
+        {"up", "2,8,32"},
+        {"in", "100000"},
+        {"out", "200000"},
+        {"threads", "1,4"},
+        {"patterns", "uniform,sorted,unsorted,clustered,outofrange"},
+        {"reps", "5"},
+        {"threshold", "0.1"}
+    };
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--quick")
+        {
+            args["taps"] = "8,128";
+            args["up"] = "8";
+            args["in"] = "10000";
+            args["out"] = "20000";
+            args["threads"] = "1";
+            args["reps"] = "3";
+        }
+        else if (arg.rfind("--", 0) == 0 && i + 1 < argc &&
+                 (args.count(arg.substr(2)) || arg == "--csv" || arg == "--json" || arg == "--baseline"))
+        {
+            args[arg.substr(2)] = argv[++i];
+        }
+        else
+        {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    // Everything that could fail is checked before the sweep, rather than after minutes of it
+    for (auto& type : split(args["types"]))
+        if (!known_types.count(type))
+            throw std::invalid_argument("unknown type: " + type + "; expected float or double");
+    for (auto& pattern : split(args["patterns"]))
+        if (!known_patterns.count(pattern))
+            throw std::invalid_argument("unknown t pattern: " + pattern);
+    // Parsed signed, since a negative length would wrap through size_t into a huge allocation
+    for (const char* name : {"taps", "up", "in", "out", "threads", "reps"})
+        for (long long value : split_numbers<long long>(args[name]))
+            if (value < 1)
+                throw std::invalid_argument(std::string("--") + name + " values must be at least 1");
+
+    const int reps = std::stoi(args["reps"]);
+    const double threshold = std::stod(args["threshold"]);
+    std::map<std::string, double> baseline;
+    if (args.count("baseline"))
+        baseline = read_baseline(args["baseline"]);
+
+    std::vector<Result> results;
+
+    printf("%-7s %5s %4s %9s %9s %3s %-11s %10s %10s %10s %8s\n",
+           "type", "taps", "up", "in", "out", "thr", "pattern", "ms", "Msamp/s", "GMAC/s", "GB/s");
+    for (auto& type : split(args["types"]))
+        for (int taps : split_numbers<int>(args["taps"]))
+            for (int up : split_numbers<int>(args["up"]))
+                for (size_t in_length : split_numbers<size_t>(args["in"]))
+                    for (size_t out_length : split_numbers<size_t>(args["out"]))
+                        for (int threads : split_numbers<int>(args["threads"]))
+                            for (auto& pattern : split(args["patterns"]))
+                            {
+                                Config config = {type, taps, up, in_length, out_length, threads, pattern};
+                                Result r = type == "float" ? run_config<float>(config, reps) : run_config<double>(config, reps);
+                                results.push_back(r);
+
+                                printf("%-7s %5d %4d %9zu %9zu %3d %-11s %10.3f %10.2f %10.2f %8.2f\n",
+                                       type.c_str(), taps, up, in_length, out_length, threads, pattern.c_str(),
+                                       r.seconds * 1e3, r.msamples_per_s, r.gmacs_per_s, r.gbytes_per_s);
+                            }
+
+    if (args.count("csv"))
+        write_csv(args["csv"], results);
+    if (args.count("json"))
+        write_json(args["json"], results);
+
+    if (!args.count("baseline"))
+        return 0;
+
+    // Regression check against the baseline; configurations it does not have are skipped
+    int compared = 0, regressions = 0;
+    for (auto& r : results)
+    {
+        auto it = baseline.find(r.config.key());
+        if (it == baseline.end())
+            continue;
+
+        compared++;
+        const double ratio = r.msamples_per_s / it->second;
+        if (ratio < 1 - threshold)
+        {
+            regressions++;
+            printf("REGRESSION %s: %.2f -> %.2f Msamples/s (%.1f%%)\n",
+                   r.config.key().c_str(), it->second, r.msamples_per_s, (ratio - 1) * 100);
+        }
+    }
+    if (compared == 0)
+    {
+        std::cerr << "no configuration of this sweep is in the baseline " << args["baseline"]
+                  << "; was it written by a sweep with other options, e.g. --quick?" << std::endl;
+        return 2;
+    }
+    printf("%d of %d configurations regressed by more than %.1f%%\n", regressions, compared, threshold * 100);
+    return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        return run(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 2;
+    }
+}
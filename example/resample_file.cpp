@@ -0,0 +1,369 @@
+// Out-of-core resampler for raw IQ captures.
+// The input (and a time vector file, if given) is memory-mapped and processed in blocks of outputs;
+// each block only reads the window of input its times need, plus the filter history before it,
+// and pages behind the current window are released, so resident memory stays flat for any file size.
+// The next window is prefetched, and streamed output is written by a second thread, while a block computes.
+//
+// Usage: resample_file --in FILE --format cf32|cf64|sc16 --in-T T --up N --taps FILE
+//                      (--t FILE | --uniform t0 dt N) --out FILE [options]
+//   --taps FILE          filter taps as text, one per line
+//   --t FILE             output times as raw float64, relative to the first input sample
+//   --uniform t0 dt N    output times t0 + k * dt, k in [0, N)
+//   --out FILE           output as raw cf32 (for cf32/sc16 input) or cf64 (for cf64 input);
+//                        outputs outside the input are zero
+//   --out-mode MODE      mmap (default) or stream
+//   --threads N          compute threads (default 1)
+//   --block N            outputs per block (default 1048576)
+//   --scale S            input scale, e.g. 1/32768 for full-scale sc16 (default 1)
+//
+// Memory stays bounded when the times are roughly non-decreasing; other orders still give
+// the right result, but each block's window may then cover much of the input.
+// Results match one interpolate_array() call over the whole file to within rounding of the time shift.
+
+#include "upfirlerp.h"
+
+#include <vector>
+#include <complex>
+#include <string>
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only or read-write mapping of a whole file
+class MappedFile
+{
+public:
+    // Maps an existing file read-only
+    explicit MappedFile(const std::string& path)
+    {
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0)
+            throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+        m_size = static_cast<size_t>(st.st_size);
+        map(PROT_READ, path);
+    }
+
+    // Creates (or truncates) a file of size bytes and maps it read-write
+    MappedFile(const std::string& path, size_t size)
+        : m_size(size)
+    {
+        m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_fd < 0)
+            throw std::runtime_error("cannot create " + path + ": " + std::strerror(errno));
+        if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+            throw std::runtime_error("cannot resize " + path + ": " + std::strerror(errno));
+        map(PROT_READ | PROT_WRITE, path);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        if (m_data)
+            ::munmap(m_data, m_size);
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+
+    char* data() const
+    {
+        return static_cast<char*>(m_data);
+    }
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    // madvise() over the whole pages inside [begin, end) bytes
+    void advise(size_t begin, size_t end, int advice) const
+    {
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        begin = (begin + page - 1) / page * page;
+        end = std::min(end, m_size) / page * page;
+        if (m_data && begin < end)
+            ::madvise(data() + begin, end - begin, advice);
+    }
+
+    // Writes back [begin, end) bytes and drops them from this process' resident set
+    void flush(size_t begin, size_t end) const
+    {
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        begin = begin / page * page;
+        end = std::min(end, m_size);
+        if (m_data && begin < end)
+            ::msync(data() + begin, end - begin, MS_ASYNC);
+        advise(begin, end, MADV_DONTNEED);
+    }
+
+protected:
+    int m_fd = -1;
+    void* m_data = nullptr;
+    size_t m_size = 0;
+
+    void map(int prot, const std::string& path)
+    {
+        if (m_size == 0)
+            return;
+        m_data = ::mmap(nullptr, m_size, prot, MAP_SHARED, m_fd, 0);
+        if (m_data == MAP_FAILED)
+        {
+            m_data = nullptr;
+            throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+        }
+    }
+};
+
+struct Options
+{
+    std::string in, format, taps, t, out, out_mode = "mmap";
+    double in_T = 0;
+    int up = 0;
+    int threads = 1;
+    size_t block = 1 << 20;
+    double scale = 1;
+    bool uniform = false;
+    double t0 = 0, dt = 0;
+    size_t N = 0;
+};
+
+static std::vector<double> read_taps(const std::string& path)
+{
+    std::ifstream f(path);
+    if (!f)
+        throw std::runtime_error("cannot open taps file " + path);
+
+    std::vector<double> taps;
+    double v;
+    while (f >> v)
+        taps.push_back(v);
+    if (taps.empty())
+        throw std::runtime_error("no taps in " + path);
+    return taps;
+}
+
+template <typename T, typename TIn>
+int run(const Options& opt)
+{
+    const std::vector<double> taps_d = read_taps(opt.taps);
+    const std::vector<T> taps(taps_d.begin(), taps_d.end());
+
+    ufl::UpfirLerp<T, TIn> upfirlerp;
+    upfirlerp.set_up_rate(opt.up)
+        .set_up_taps(taps)
+        .set_input_scale(static_cast<T>(opt.scale))
+        .set_threads(opt.threads);
+    const size_t history = static_cast<size_t>((taps.size() + opt.up - 1) / opt.up) + 1;
+
+    MappedFile input(opt.in);
+    const size_t in_length = input.size() / sizeof(std::complex<TIn>);
+    const std::complex<TIn>* in = reinterpret_cast<const std::complex<TIn>*>(input.data());
+    if (in_length == 0)
+        throw std::runtime_error("input file is empty");
+    const double t_last = opt.in_T / opt.up * (static_cast<double>(in_length) * opt.up - 1);
+
+    std::unique_ptr<MappedFile> tfile;
+    size_t out_length = opt.N;
+    if (!opt.uniform)
+    {
+        tfile.reset(new MappedFile(opt.t));
+        out_length = tfile->size() / sizeof(double);
+    }
+    const double* tall = tfile ? reinterpret_cast<const double*>(tfile->data()) : nullptr;
+
+    // Output: either mapped, written in place, or two block buffers alternating with a writer thread
+    const size_t out_bytes = out_length * sizeof(std::complex<T>);
+    std::unique_ptr<MappedFile> outmap;
+    FILE* outstream = nullptr;
+    std::vector<std::complex<T>> outbuf[2];
+    std::future<bool> pending;
+    if (opt.out_mode == "mmap")
+    {
+        outmap.reset(new MappedFile(opt.out, out_bytes));
+    }
+    else if (opt.out_mode == "stream")
+    {
+        outstream = std::fopen(opt.out.c_str(), "wb");
+        if (!outstream)
+            throw std::runtime_error("cannot create " + opt.out);
+        outbuf[0].resize(std::min(opt.block, out_length));
+        outbuf[1].resize(std::min(opt.block, out_length));
+    }
+    else
+    {
+        throw std::invalid_argument("unknown --out-mode " + opt.out_mode);
+    }
+
+    std::vector<double> trel(std::min(opt.block, out_length));
+    size_t released_in = 0, released_t = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    size_t blocks = 0;
+    for (size_t b0 = 0; b0 < out_length; b0 += opt.block, blocks++)
+    {
+        const size_t n = std::min(opt.block, out_length - b0);
+        std::complex<T>* out;
+        if (outmap)
+        {
+            out = reinterpret_cast<std::complex<T>*>(outmap->data()) + b0;
+        }
+        else
+        {
+            out = outbuf[blocks % 2].data();
+            std::fill(out, out + n, std::complex<T>(0, 0));
+        }
+
+        // Input window of this block's times; the library zero-pads outside what it is given,
+        // so the window starts the filter history before the earliest time
+        double tmin = t_last, tmax = 0;
+        bool any = false;
+        for (size_t k = 0; k < n; k++)
+        {
+            const double tk = tall ? tall[b0 + k] : opt.t0 + static_cast<double>(b0 + k) * opt.dt;
+            trel[k] = tk;
+            if (tk >= 0 && tk <= t_last)
+            {
+                tmin = std::min(tmin, tk);
+                tmax = std::max(tmax, tk);
+                any = true;
+            }
+        }
+
+        if (any)
+        {
+            const size_t first = static_cast<size_t>(tmin / opt.in_T);
+            const size_t s0 = first > history ? first - history : 0;
+            const size_t s1 = std::min(in_length, static_cast<size_t>(std::ceil(tmax / opt.in_T)) + 2);
+            const double shift = static_cast<double>(s0) * opt.in_T;
+            for (size_t k = 0; k < n; k++)
+                trel[k] = trel[k] >= 0 && trel[k] <= t_last ? trel[k] - shift : -1.0;
+
+            upfirlerp.interpolate_array(in + s0, s1 - s0, opt.in_T, trel.data(), n, out);
+
+            // Nothing before this window is needed again when the times move forward;
+            // read ahead over a window of the same size after it
+            input.advise(released_in, s0 * sizeof(std::complex<TIn>), MADV_DONTNEED);
+            released_in = std::max(released_in, s0 * sizeof(std::complex<TIn>));
+            input.advise(s1 * sizeof(std::complex<TIn>), (2 * s1 - s0) * sizeof(std::complex<TIn>), MADV_WILLNEED);
+        }
+
+        if (tfile)
+        {
+            const size_t tend = (b0 + n) * sizeof(double);
+            tfile->advise(released_t, tend, MADV_DONTNEED);
+            released_t = tend;
+            tfile->advise(tend, tend + n * sizeof(double), MADV_WILLNEED);
+        }
+
+        if (outmap)
+        {
+            outmap->flush(b0 * sizeof(std::complex<T>), (b0 + n) * sizeof(std::complex<T>));
+        }
+        else
+        {
+            // The previous block's write overlapped with this block's compute
+            if (pending.valid() && !pending.get())
+                throw std::runtime_error("short write to " + opt.out);
+            pending = std::async(std::launch::async, [outstream, out, n] {
+                return std::fwrite(out, sizeof(std::complex<T>), n, outstream) == n;
+            });
+        }
+    }
+
+    if (pending.valid() && !pending.get())
+        throw std::runtime_error("short write to " + opt.out);
+    if (outstream && std::fclose(outstream) != 0)
+        throw std::runtime_error("cannot close " + opt.out);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    printf("%zu outputs from %zu inputs in %zu blocks, %.3f s (%.2f Msamples/s), peak resident %.1f MB\n",
+           out_length, in_length, blocks, seconds, out_length / seconds * 1e-6, usage.ru_maxrss / 1024.0);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--uniform" && i + 3 < argc)
+        {
+            opt.uniform = true;
+            opt.t0 = std::stod(argv[++i]);
+            opt.dt = std::stod(argv[++i]);
+            opt.N = static_cast<size_t>(std::stoull(argv[++i]));
+        }
+        else if (arg.rfind("--", 0) == 0 && i + 1 < argc)
+        {
+            args[arg.substr(2)] = argv[++i];
+        }
+        else
+        {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    try
+    {
+        for (const char* required : {"in", "format", "in-T", "up", "taps", "out"})
+            if (!args.count(required))
+                throw std::invalid_argument(std::string("missing --") + required);
+        if (!opt.uniform && !args.count("t"))
+            throw std::invalid_argument("one of --t or --uniform is required");
+
+        opt.in = args["in"];
+        opt.format = args["format"];
+        opt.in_T = std::stod(args["in-T"]);
+        opt.up = std::stoi(args["up"]);
+        opt.taps = args["taps"];
+        opt.out = args["out"];
+        if (args.count("t"))
+            opt.t = args["t"];
+        if (args.count("out-mode"))
+            opt.out_mode = args["out-mode"];
+        if (args.count("threads"))
+            opt.threads = std::stoi(args["threads"]);
+        if (args.count("block"))
+            opt.block = static_cast<size_t>(std::stoull(args["block"]));
+        if (args.count("scale"))
+            opt.scale = std::stod(args["scale"]);
+        if (!(opt.in_T > 0) || opt.up < 1 || opt.threads < 1 || opt.block == 0)
+            throw std::invalid_argument("--in-T, --up, --threads and --block must be positive");
+
+        if (opt.format == "cf32")
+            return run<float, float>(opt);
+        if (opt.format == "cf64")
+            return run<double, double>(opt);
+        if (opt.format == "sc16")
+            return run<float, int16_t>(opt);
+        throw std::invalid_argument("unknown --format " + opt.format + ", expected cf32, cf64 or sc16");
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
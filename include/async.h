@@ -0,0 +1,302 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <complex>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+
+namespace ufl
+{
+
+// Runs the calls of one interpolator on threads of their own, so that a producer can hand over
+// block N + 1 while block N is still being resampled.
+// Jobs run one at a time in submission order, each split over the interpolator's own threads.
+// A job's optional callback then runs on a second thread, again in submission order, while the
+// next job computes, so input, interpolation and downstream processing of three blocks overlap.
+// A job's future is ready once both have finished; it carries any exception of either, and a
+// job that threw skips its callback.
+// At most depth jobs wait or compute with their callbacks not yet started; submit() blocks beyond that.
+// A job gives up its place before its callback runs, so a callback may submit the next job, which never blocks,
+// and may wait(), which then returns once every job has computed; their callbacks follow in turn.
+// The buffers of a job must stay alive and untouched until its future is ready, and the interpolator
+// must not be used or reconfigured directly while jobs are in flight; wait() first.
+// Submitting allocates the job, so unlike the interpolator's own calls this is not for a real-time thread.
+template <typename Ufl>
+class AsyncQueue
+{
+public:
+    using Callback = std::function<void()>;
+
+    explicit AsyncQueue(Ufl& ufl, size_t depth = 3)
+        : m_ufl(ufl), m_depth(depth > 0 ? depth : 1)
+    {
+        m_runner = std::thread(&AsyncQueue::run_loop, this);
+        m_completer = std::thread(&AsyncQueue::complete_loop, this);
+    }
+
+    // Finishes every job in flight first
+    ~AsyncQueue()
+    {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv_jobs.notify_all();
+        m_cv_done.notify_all();
+        m_runner.join();
+        m_completer.join();
+    }
+
+    AsyncQueue(const AsyncQueue&) = delete;
+    AsyncQueue& operator=(const AsyncQueue&) = delete;
+
+    // interpolate_array() at the times t[0, out_length)
+    template <typename TIn, typename T>
+    std::future<void> submit(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t out_length,
+        std::complex<T>* const out,
+        Callback done = Callback()
+    ){
+        return submit([=](Ufl& ufl) {
+            ufl.interpolate_array(in, in_length, in_T, t, out_length, out);
+        }, std::move(done));
+    }
+
+    // interpolate_uniform_array() at the times t0 + k * dt, k in [0, out_length)
+    template <typename TIn, typename T>
+    std::future<void> submit_uniform(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t out_length,
+        std::complex<T>* const out,
+        Callback done = Callback()
+    ){
+        return submit([=](Ufl& ufl) {
+            ufl.interpolate_uniform_array(in, in_length, in_T, t0, dt, out_length, out);
+        }, std::move(done));
+    }
+
+    // Any other use of the interpolator, as f(ufl), e.g. a call with an epilogue op
+    template <typename F>
+    std::future<void> submit(F&& f, Callback done = Callback())
+    {
+        Job job;
+        job.run = std::forward<F>(f);
+        job.done = std::move(done);
+        std::future<void> future = job.promise.get_future();
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!in_callback())
+                m_cv_space.wait(lock, [&]{ return m_in_flight < m_depth; });
+            m_in_flight++;
+            m_computing++;
+            m_pending++;
+            m_jobs.push_back(std::move(job));
+        }
+        m_cv_jobs.notify_one();
+        return future;
+    }
+
+    // Blocks until every job submitted so far has completed, or from a callback, until every one has computed
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (in_callback())
+            m_cv_space.wait(lock, [&]{ return m_computing == 0; });
+        else
+            m_cv_space.wait(lock, [&]{ return m_pending == 0; });
+    }
+
+    size_t get_depth() const
+    {
+        return m_depth;
+    }
+
+    // Jobs submitted whose callbacks have not started yet
+    size_t in_flight() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_in_flight;
+    }
+
+protected:
+    struct Job
+    {
+        std::function<void(Ufl&)> run;
+        Callback done;
+        std::promise<void> promise;
+        std::exception_ptr error;
+    };
+
+    Ufl& m_ufl;
+    const size_t m_depth;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv_jobs;      // a job was submitted
+    std::condition_variable m_cv_done;      // a job finished computing
+    std::condition_variable m_cv_space;     // a job computed, started its callback or completed
+    std::deque<Job> m_jobs;                 // waiting to compute
+    std::deque<Job> m_done;                 // waiting for their callbacks
+    size_t m_in_flight = 0;                 // submitted, callback not yet started
+    size_t m_computing = 0;                 // submitted, not yet computed
+    size_t m_pending = 0;                   // submitted, not yet completed
+    bool m_stop = false;
+
+    std::thread m_runner;
+    std::thread m_completer;
+
+    // Whether the caller is a callback, which must not wait for its own completion
+    bool in_callback() const
+    {
+        return std::this_thread::get_id() == m_completer.get_id();
+    }
+
+    void run_loop()
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_jobs.wait(lock, [&]{ return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty())
+                return;
+            Job job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            lock.unlock();
+
+            try
+            {
+                job.run(m_ufl);
+            }
+            catch (...)
+            {
+                job.error = std::current_exception();
+            }
+
+            lock.lock();
+            m_done.push_back(std::move(job));
+            m_computing--;
+            lock.unlock();
+            m_cv_done.notify_one();
+            m_cv_space.notify_all();
+        }
+    }
+
+    void complete_loop()
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_done.wait(lock, [&]{ return m_stop || !m_done.empty(); });
+            if (m_done.empty())
+                return;
+            Job job = std::move(m_done.front());
+            m_done.pop_front();
+            m_in_flight--;
+            lock.unlock();
+            m_cv_space.notify_all();
+
+            if (!job.error && job.done)
+            {
+                try
+                {
+                    job.done();
+                }
+                catch (...)
+                {
+                    job.error = std::current_exception();
+                }
+            }
+            if (job.error)
+                job.promise.set_exception(job.error);
+            else
+                job.promise.set_value();
+
+            lock.lock();
+            m_pending--;
+            lock.unlock();
+            m_cv_space.notify_all();
+        }
+    }
+};
+
+// Fixed set of reusable buffers that a producer cycles through: two slots for double buffering,
+// three for triple, so that it fills one while the jobs of the others compute and drain.
+// Slot is whatever one block needs, e.g. its input, times and outputs; size them once up front.
+//     Slot& slot = ring.acquire();
+//     ... fill slot ...
+//     ring.release(queue.submit(..., [&slot]{ ... consume slot ... }));
+template <typename Slot>
+class BufferRing
+{
+public:
+    explicit BufferRing(size_t slots)
+        : m_slots(slots > 0 ? slots : 1), m_done(m_slots.size())
+    {}
+
+    size_t size() const
+    {
+        return m_slots.size();
+    }
+
+    Slot& operator[](size_t i)
+    {
+        return m_slots[i];
+    }
+
+    // The next slot in turn, once the job last released with it has completed; rethrows that job's error
+    Slot& acquire()
+    {
+        if (m_acquired)
+            throw std::logic_error("release() the acquired slot first");
+
+        std::future<void>& done = m_done[m_next];
+        if (done.valid())
+            done.get();
+        m_acquired = true;
+        return m_slots[m_next];
+    }
+
+    // Hands the acquired slot to the job that completes done
+    void release(std::future<void> done)
+    {
+        if (!m_acquired)
+            throw std::logic_error("no slot was acquired");
+
+        m_done[m_next] = std::move(done);
+        m_acquired = false;
+        m_next = (m_next + 1) % m_slots.size();
+    }
+
+    // Waits for the jobs of every slot, rethrowing the first error
+    void drain()
+    {
+        for (auto& done : m_done)
+            if (done.valid())
+                done.get();
+    }
+
+protected:
+    std::vector<Slot> m_slots;
+    std::vector<std::future<void>> m_done;
+    size_t m_next = 0;
+    bool m_acquired = false;
+};
+
+}
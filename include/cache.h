@@ -0,0 +1,215 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace ufl
+{
+
+// Cumulative counters of an InterrimCache
+struct CacheStats
+{
+    size_t hits = 0;        // needed interrim samples that were already computed
+    size_t misses = 0;      // needed interrim samples that had to be computed
+    size_t evictions = 0;   // tiles dropped to make room
+    size_t bypassed = 0;    // calls that needed more tiles than the cache holds, and ran uncached
+};
+
+// Tiles of interrim samples kept between calls on the same input, for callers that
+// interpolate the same signal repeatedly at slightly moved times.
+// Tile k holds interrim samples [k * tile, (k + 1) * tile). A slot map over every tile of the
+// bound input says which tiles are held, and a validity bitmap per tile which of their samples
+// have been computed, so only samples that are actually needed are ever evaluated.
+// At most capacity tiles are stored; when full, the least recently needed ones are evicted, clock-style.
+// Not thread-safe by itself: the owner plans each call serially, then fills and reads
+// the planned tiles from several threads.
+template <typename T>
+class InterrimCache
+{
+public:
+    static constexpr int tile = 256;
+    static constexpr int words = tile / 64;
+
+    // Maximum number of tiles held; 0 disables the cache and frees it
+    void set_capacity(size_t tiles)
+    {
+        m_capacity = tiles;
+        m_data.clear();
+        m_data.shrink_to_fit();
+        m_valid.clear();
+        m_valid.shrink_to_fit();
+        m_tile_of.clear();
+        m_last_call.clear();
+        m_referenced.clear();
+        m_free.clear();
+        m_hand = 0;
+        std::fill(m_slot_of.begin(), m_slot_of.end(), -1);
+        m_stats = CacheStats();
+    }
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+    bool enabled() const
+    {
+        return m_capacity > 0;
+    }
+
+    // Drops every tile, keeping the storage
+    void invalidate()
+    {
+        std::fill(m_slot_of.begin(), m_slot_of.end(), -1);
+        std::fill(m_tile_of.begin(), m_tile_of.end(), -1);
+        m_free.clear();
+        for (size_t s = m_tile_of.size(); s > 0; s--)
+            m_free.push_back(static_cast<int>(s - 1));
+    }
+
+    // Binds the cache to an input of tiles tiles; any other buffer or length than the last drops every tile.
+    // Changes to the contents of the same buffer are not detected, see invalidate().
+    void bind(const void* in, const size_t in_length, const size_t tiles)
+    {
+        if (in == m_in && in_length == m_in_length && tiles == m_slot_of.size())
+            return;
+
+        m_in = in;
+        m_in_length = in_length;
+        m_slot_of.assign(tiles, -1);
+        m_needed_in.assign(tiles, 0);
+        invalidate();
+    }
+
+    // Starts planning a call; tiles are then declared with need()
+    void begin_call()
+    {
+        m_call++;
+        m_needed.clear();
+    }
+
+    void need(const int64_t k)
+    {
+        if (m_needed_in[k] != m_call)
+        {
+            m_needed_in[k] = m_call;
+            m_needed.push_back(k);
+        }
+    }
+
+    // Assigns a slot to every needed tile; tiles not held yet start with no valid samples.
+    // Returns false, leaving the cache untouched, if the call needs more tiles than it holds.
+    bool acquire()
+    {
+        if (m_needed.size() > m_capacity)
+        {
+            m_stats.bypassed++;
+            return false;
+        }
+
+        for (int64_t k : m_needed)
+        {
+            int slot = m_slot_of[k];
+            if (slot < 0)
+            {
+                slot = free_slot();
+                m_slot_of[k] = slot;
+                m_tile_of[slot] = k;
+                std::fill(m_valid.begin() + static_cast<size_t>(slot) * words,
+                          m_valid.begin() + static_cast<size_t>(slot + 1) * words, uint64_t(0));
+            }
+            m_last_call[slot] = m_call;
+            m_referenced[slot] = 1;
+        }
+        return true;
+    }
+
+    // Whether sample j, in an acquired tile, still has to be computed; it counts as valid afterwards
+    bool claim(const int64_t j)
+    {
+        uint64_t& word = m_valid[static_cast<size_t>(m_slot_of[j / tile]) * words + (j % tile) / 64];
+        const uint64_t bit = uint64_t(1) << (j % 64);
+        if (word & bit)
+        {
+            m_stats.hits++;
+            return false;
+        }
+        word |= bit;
+        m_stats.misses++;
+        return true;
+    }
+
+    // Interrim sample j, whose tile must have been acquired
+    std::complex<T>& sample(const int64_t j)
+    {
+        return m_data[static_cast<size_t>(m_slot_of[j / tile]) * tile + j % tile];
+    }
+
+    const CacheStats& stats() const
+    {
+        return m_stats;
+    }
+
+protected:
+    size_t m_capacity = 0;
+    const void* m_in = nullptr;
+    size_t m_in_length = 0;
+
+    std::vector<std::complex<T>> m_data;    // slot s at [s * tile, (s + 1) * tile)
+    std::vector<uint64_t> m_valid;          // slot s at [s * words, (s + 1) * words), a bit per sample
+    std::vector<int> m_slot_of;             // per tile of the input, -1 when not held
+    std::vector<int64_t> m_tile_of;         // per slot, -1 when free
+    std::vector<unsigned> m_last_call;      // per slot, the last call that needed it
+    std::vector<char> m_referenced;         // per slot, the clock's second-chance bit
+    std::vector<int> m_free;                // slots holding no tile
+    size_t m_hand = 0;
+
+    unsigned m_call = 0;
+    std::vector<unsigned> m_needed_in;      // per tile of the input, the last call that needed it
+    std::vector<int64_t> m_needed;          // tiles needed by the current call
+
+    CacheStats m_stats;
+
+    // A free slot, growing the storage up to capacity, otherwise the first one the clock hand
+    // finds that the current call does not need and that was not needed since the hand last passed
+    int free_slot()
+    {
+        if (!m_free.empty())
+        {
+            const int s = m_free.back();
+            m_free.pop_back();
+            return s;
+        }
+
+        if (m_tile_of.size() < m_capacity)
+        {
+            m_tile_of.push_back(-1);
+            m_last_call.push_back(0);
+            m_referenced.push_back(0);
+            m_data.resize(m_tile_of.size() * tile);
+            m_valid.resize(m_tile_of.size() * words);
+            return static_cast<int>(m_tile_of.size() - 1);
+        }
+
+        while (true)
+        {
+            const size_t s = m_hand;
+            m_hand = (m_hand + 1) % m_tile_of.size();
+            if (m_last_call[s] == m_call)
+                continue;
+            if (m_referenced[s])
+            {
+                m_referenced[s] = 0;
+                continue;
+            }
+
+            m_slot_of[m_tile_of[s]] = -1;
+            m_tile_of[s] = -1;
+            m_stats.evictions++;
+            return static_cast<int>(s);
+        }
+    }
+};
+
+}
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <algorithm>
+#include <new>
+
+// Keeps a bulky epilogue out of the interpolation loop that calls it, which it would otherwise crowd
+#if defined(__GNUC__)
+#define UFL_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define UFL_NOINLINE __declspec(noinline)
+#else
+#define UFL_NOINLINE
+#endif
+
+namespace ufl
+{
+
+// Fused epilogues.
+// interpolate_array() and interpolate_uniform_array() accept an epilogue op, which takes over
+// the store of the valid outputs while they are still in a small buffer in L1,
+// so mixing, scaling, accumulating or correlating the output needs no second pass over it.
+// An op provides
+//   void grid(double t0, double dt)
+//       called once per call before any output: the uniform grid t0 + k * dt, or dt = 0 for a time vector
+//   void operator()(size_t i0, size_t n, const double* t, std::complex<T>* y, std::complex<T>* out)
+//       stores the n consecutive outputs i0 + k, interpolated as y[k] at times t[k], into out[k];
+//       t is nullptr on a uniform grid, and y may be overwritten
+//   Op fork() const
+//       a copy for one slice of the outputs, with its reductions cleared
+//   void join(const Op& part)
+//       folds a slice's reductions back in; slices are joined in output order
+// Slices may run on different threads, each with its own fork; runs within a slice come in increasing i0.
+// A call with a single slice hands it the op itself, without fork() or join().
+
+// Longest run of outputs handed to an op at once
+constexpr size_t epilogue_tile = 256;
+
+namespace detail
+{
+
+// The plain store every call without an epilogue uses
+template <typename T>
+struct StoreOutput
+{
+    void grid(double, double) {}
+
+    void operator()(size_t, size_t n, const double*, std::complex<T>* y, std::complex<T>* out)
+    {
+        std::copy(y, y + n, out);
+    }
+
+    StoreOutput fork() const
+    {
+        return *this;
+    }
+    void join(const StoreOutput&) {}
+};
+
+// Raw storage for the forks of an op, kept by the interpolator between calls,
+// so forking does not allocate once it has grown to the largest call
+class ForkStore
+{
+public:
+    // Room for n objects of type Op, or nullptr if Op is over-aligned for it
+    template <typename Op>
+    Op* acquire(size_t n)
+    {
+        if (alignof(Op) > alignof(std::max_align_t))
+            return nullptr;
+
+        const size_t words = (n * sizeof(Op) + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+        if (m_words.size() < words)
+            m_words.resize(words);
+        return reinterpret_cast<Op*>(m_words.data());
+    }
+
+protected:
+    std::vector<std::max_align_t> m_words;
+};
+
+// Forks of an op for n slices, joined back in slice order.
+// A single slice is the op itself, and stateless ops are shared, so neither allocates.
+template <typename Op, bool Stateless = std::is_empty<Op>::value>
+class EpilogueParts
+{
+public:
+    EpilogueParts(Op& op, size_t n, ForkStore& store) : m_n(n)
+    {
+        if (n == 1)
+        {
+            m_parts = &op;
+            return;
+        }
+
+        m_parts = store.acquire<Op>(n);
+        if (!m_parts)
+        {
+            m_owned.resize(n);
+            m_parts = reinterpret_cast<Op*>(m_owned.data());
+        }
+        for (; m_forked < n; m_forked++)
+            new (m_parts + m_forked) Op(op.fork());
+    }
+
+    ~EpilogueParts()
+    {
+        if (m_n != 1)
+            for (size_t k = 0; k < m_forked; k++)
+                m_parts[k].~Op();
+    }
+
+    EpilogueParts(const EpilogueParts&) = delete;
+    EpilogueParts& operator=(const EpilogueParts&) = delete;
+
+    Op& operator[](size_t k)
+    {
+        return m_parts[k];
+    }
+
+    void join(Op& op)
+    {
+        if (m_n != 1)
+            for (size_t k = 0; k < m_n; k++)
+                op.join(m_parts[k]);
+    }
+
+protected:
+    struct alignas(Op) Slot
+    {
+        unsigned char bytes[sizeof(Op)];
+    };
+
+    size_t m_n;
+    size_t m_forked = 0;
+    Op* m_parts = nullptr;
+    std::vector<Slot> m_owned;      // for ops too aligned for the store
+};
+
+template <typename Op>
+class EpilogueParts<Op, true>
+{
+public:
+    EpilogueParts(Op& op, size_t, ForkStore&) : m_op(op) {}
+
+    Op& operator[](size_t)
+    {
+        return m_op;
+    }
+
+    void join(Op&) {}
+
+protected:
+    Op& m_op;
+};
+
+// Collects the outputs of one slice into runs of consecutive indices and hands each run to the op
+template <typename T, typename Op>
+class EpilogueStage
+{
+public:
+    // t is the time vector, or nullptr on a uniform grid
+    EpilogueStage(Op& op, const double* t, std::complex<T>* out) : m_op(op), m_t(t), m_out(out) {}
+    ~EpilogueStage()
+    {
+        flush();
+    }
+
+    void push(size_t i, const std::complex<T>& y)
+    {
+        if (m_n == epilogue_tile || i != m_i0 + m_n)
+        {
+            flush();
+            m_i0 = i;
+        }
+        m_y[m_n++] = y;
+    }
+
+    void flush()
+    {
+        if (m_n > 0)
+            m_op(m_i0, m_n, m_t ? m_t + m_i0 : nullptr, m_y, m_out + m_i0);
+        m_n = 0;
+    }
+
+protected:
+    Op& m_op;
+    const double* m_t;
+    std::complex<T>* m_out;
+    size_t m_i0 = 0;
+    size_t m_n = 0;
+    std::complex<T> m_y[epilogue_tile];
+};
+
+// The plain store skips the buffer
+template <typename T>
+class EpilogueStage<T, StoreOutput<T>>
+{
+public:
+    EpilogueStage(StoreOutput<T>&, const double*, std::complex<T>* out) : m_out(out) {}
+
+    void push(size_t i, const std::complex<T>& y)
+    {
+        m_out[i] = y;
+    }
+
+    void flush() {}
+
+protected:
+    std::complex<T>* m_out;
+};
+
+} // namespace detail
+
+// Built-in epilogue: v = gain * y * exp(i (2 pi freq t + phase)), then out = v, or out += v when accumulating,
+// and optionally a running dot product sum(conj(ref[i]) * v) over the valid outputs.
+// Each enabled operation is one tight loop over the run.
+// On a uniform grid the mixer is a phase-recurrence oscillator, one complex multiply per output,
+// re-seeded from the exact phase every resync_interval outputs; for a time vector it evaluates the phase directly.
+template <typename T>
+class FusedOps
+{
+public:
+    static constexpr size_t resync_interval = 1024;
+    static constexpr double two_pi = 6.283185307179586;
+
+    FusedOps& set_gain(T gain)
+    {
+        m_gain = gain;
+        return *this;
+    }
+    T get_gain() const
+    {
+        return m_gain;
+    }
+
+    // Frequency in cycles per unit of t, phase in radians at t = 0; a frequency of 0 disables the mixer
+    FusedOps& set_mixer(double freq, double phase = 0)
+    {
+        m_freq = freq;
+        m_phase = phase;
+        return *this;
+    }
+
+    // Adds into the existing outputs instead of overwriting them
+    FusedOps& set_accumulate(bool accumulate)
+    {
+        m_accumulate = accumulate;
+        return *this;
+    }
+
+    // Reference indexed like the outputs, for the running dot product; nullptr disables it
+    FusedOps& set_reference(const std::complex<T>* ref)
+    {
+        m_ref = ref;
+        return *this;
+    }
+
+    // Dot product accumulated since the last reset_dot(), over every call using this op
+    std::complex<T> get_dot() const
+    {
+        return m_dot;
+    }
+    void reset_dot()
+    {
+        m_dot = 0;
+    }
+
+    void grid(double t0, double dt)
+    {
+        m_t0 = t0;
+        m_dt = dt;
+        const double cycles = m_freq * dt;
+        m_step = std::polar(1.0, two_pi * (cycles - std::floor(cycles)));
+        m_next = 0;
+        m_left = 0;
+    }
+
+    UFL_NOINLINE void operator()(size_t i0, size_t n, const double* t, std::complex<T>* y, std::complex<T>* out)
+    {
+        if (m_gain != T(1))
+            for (size_t k = 0; k < n; k++)
+                y[k] *= m_gain;
+
+        if (m_freq != 0)
+            mix(i0, n, t, y);
+
+        // Complex products are spelled out, which skips the NaN recovery of std::complex and lets them vectorise
+        if (m_ref)
+        {
+            const std::complex<T>* ref = m_ref + i0;
+            T re = 0, im = 0;
+            for (size_t k = 0; k < n; k++)
+            {
+                re += ref[k].real() * y[k].real() + ref[k].imag() * y[k].imag();
+                im += ref[k].real() * y[k].imag() - ref[k].imag() * y[k].real();
+            }
+            m_dot += std::complex<T>(re, im);
+        }
+
+        if (m_accumulate)
+            for (size_t k = 0; k < n; k++)
+                out[k] += y[k];
+        else
+            std::copy(y, y + n, out);
+    }
+
+    FusedOps fork() const
+    {
+        FusedOps part(*this);
+        part.m_dot = 0;
+        part.m_left = 0;
+        return part;
+    }
+
+    void join(const FusedOps& part)
+    {
+        m_dot += part.m_dot;
+    }
+
+protected:
+    T m_gain = 1;
+    double m_freq = 0;
+    double m_phase = 0;
+    bool m_accumulate = false;
+    const std::complex<T>* m_ref = nullptr;
+    std::complex<T> m_dot = 0;
+
+    // Uniform grid of the current call, dt = 0 for a time vector, and the oscillator over it
+    double m_t0 = 0;
+    double m_dt = 0;
+    std::complex<double> m_step = 1;
+    std::complex<double> m_rot = 1;
+    size_t m_next = 0;
+    size_t m_left = 0;
+
+    // exp(i (2 pi freq t + phase)), with whole cycles removed before scaling so large t keep their precision
+    std::complex<double> exact(double t) const
+    {
+        const double cycles = m_freq * t;
+        return std::polar(1.0, two_pi * (cycles - std::floor(cycles)) + m_phase);
+    }
+
+    static void rotate(std::complex<T>& y, const std::complex<double>& rot)
+    {
+        const T c = static_cast<T>(rot.real()), s = static_cast<T>(rot.imag());
+        y = std::complex<T>(y.real() * c - y.imag() * s, y.real() * s + y.imag() * c);
+    }
+
+    void mix(size_t i0, size_t n, const double* t, std::complex<T>* y)
+    {
+        if (t)
+        {
+            for (size_t k = 0; k < n; k++)
+                rotate(y[k], exact(t[k]));
+            return;
+        }
+
+        // Continue the oscillator where the last run stopped, unless there was a gap
+        size_t left = i0 == m_next ? m_left : 0;
+        double c = m_rot.real(), s = m_rot.imag();
+        const double step_c = m_step.real(), step_s = m_step.imag();
+        for (size_t k = 0; k < n; k++)
+        {
+            if (left == 0)
+            {
+                const std::complex<double> rot = exact(m_t0 + static_cast<double>(i0 + k) * m_dt);
+                c = rot.real();
+                s = rot.imag();
+                left = resync_interval;
+            }
+            rotate(y[k], std::complex<double>(c, s));
+            const double next_c = c * step_c - s * step_s;
+            s = c * step_s + s * step_c;
+            c = next_c;
+            left--;
+        }
+        m_rot = std::complex<double>(c, s);
+        m_left = left;
+        m_next = i0 + n;
+    }
+};
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace ufl
+{
+
+// Self-contained complex FFT over power-of-two sizes: iterative radix-2, decimation in time,
+// with the bit-reversal permutation and every stage's twiddles precomputed in double precision.
+// Both directions are unscaled, so inverse(forward(x)) is size() * x.
+template <typename T>
+class Fft
+{
+public:
+    Fft() = default;
+    explicit Fft(size_t n)
+    {
+        resize(n);
+    }
+
+    void resize(size_t n)
+    {
+        if (n == 0 || (n & (n - 1)) != 0)
+            throw std::invalid_argument("FFT size must be a power of two");
+
+        m_n = n;
+        int bits = 0;
+        while ((size_t(1) << bits) < n)
+            bits++;
+
+        m_rev.resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t r = 0;
+            for (int b = 0; b < bits; b++)
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            m_rev[i] = r;
+        }
+
+        // The stage joining halves of length h uses cos and sin of 2 pi k / (2h), k < h, stored from h - 1 on
+        const double pi = 3.14159265358979323846;
+        m_cos.resize(n > 1 ? n - 1 : 1);
+        m_sin.resize(n > 1 ? n - 1 : 1);
+        for (size_t h = 1; h < n; h <<= 1)
+        {
+            for (size_t k = 0; k < h; k++)
+            {
+                m_cos[h - 1 + k] = static_cast<T>(std::cos(pi * k / h));
+                m_sin[h - 1 + k] = static_cast<T>(std::sin(pi * k / h));
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return m_n;
+    }
+
+    // x[k] = sum_i x[i] exp(-2 pi i k / n), in place
+    void forward(std::complex<T>* x) const
+    {
+        transform(x, T(-1));
+    }
+
+    // x[k] = sum_i x[i] exp(+2 pi i k / n), in place
+    void inverse(std::complex<T>* x) const
+    {
+        transform(x, T(1));
+    }
+
+protected:
+    size_t m_n = 0;
+    std::vector<size_t> m_rev;
+    std::vector<T> m_cos;
+    std::vector<T> m_sin;
+
+    // Butterflies are spelled out on the flat real and imaginary parts,
+    // which skips the NaN recovery of std::complex and lets the inner loop vectorise
+    void transform(std::complex<T>* x, const T sign) const
+    {
+        for (size_t i = 0; i < m_n; i++)
+            if (i < m_rev[i])
+                std::swap(x[i], x[m_rev[i]]);
+
+        T* v = reinterpret_cast<T*>(x);
+        for (size_t i = 0; i + 1 < m_n; i += 2)
+        {
+            const T ar = v[2 * i], ai = v[2 * i + 1];
+            const T br = v[2 * i + 2], bi = v[2 * i + 3];
+            v[2 * i] = ar + br;
+            v[2 * i + 1] = ai + bi;
+            v[2 * i + 2] = ar - br;
+            v[2 * i + 3] = ai - bi;
+        }
+
+        for (size_t h = 2; h < m_n; h <<= 1)
+        {
+            const T* wc = m_cos.data() + h - 1;
+            const T* ws = m_sin.data() + h - 1;
+            for (size_t i = 0; i < m_n; i += 2 * h)
+            {
+                T* a = v + 2 * i;
+                T* b = v + 2 * (i + h);
+                for (size_t k = 0; k < h; k++)
+                {
+                    const T c = wc[k], s = sign * ws[k];
+                    const T br = b[2 * k] * c - b[2 * k + 1] * s;
+                    const T bi = b[2 * k] * s + b[2 * k + 1] * c;
+                    const T ar = a[2 * k], ai = a[2 * k + 1];
+                    a[2 * k] = ar + br;
+                    a[2 * k + 1] = ai + bi;
+                    b[2 * k] = ar - br;
+                    b[2 * k + 1] = ai - bi;
+                }
+            }
+        }
+    }
+};
+
+}
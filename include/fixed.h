@@ -0,0 +1,285 @@
+#pragma once
+
+#include "upfirlerp.h"
+
+#include <array>
+#include <memory>
+
+namespace ufl
+{
+namespace detail
+{
+
+// Dot product of L taps against L contiguous input samples, unrolled at compile time.
+// The real and imaginary parts accumulate separately, in the same order as simd::dot_scalar.
+template <typename T, typename TIn, int Q, int L>
+struct UnrolledDot
+{
+    static void run(const T* taps, const std::complex<TIn>* in, T& re, T& im)
+    {
+        re += static_cast<T>(in[Q].real()) * taps[Q];
+        im += static_cast<T>(in[Q].imag()) * taps[Q];
+        UnrolledDot<T, TIn, Q + 1, L>::run(taps, in, re, im);
+    }
+};
+
+template <typename T, typename TIn, int L>
+struct UnrolledDot<T, TIn, L, L>
+{
+    static void run(const T*, const std::complex<TIn>*, T&, T&) {}
+};
+
+} // namespace detail
+
+// Resampler specialised for one filter shape, NTAPS taps at upsample rate UP.
+// The polyphase bank lives in a std::array, the phase and window follow from constants,
+// and every interrim sample whose window lies inside the signal is an unrolled dot product
+// without clamps; only the few at the signal edges take the generic path.
+template <typename T, int NTAPS, int UP, typename TIn = T>
+class UpfirLerpFixed : public BaseUpfirLerp<T, UpfirLerpFixed<T, NTAPS, UP, TIn>, TIn>
+{
+    static_assert(NTAPS > 0 && UP > 0, "NTAPS and UP must be positive");
+
+    using Base = BaseUpfirLerp<T, UpfirLerpFixed<T, NTAPS, UP, TIn>, TIn>;
+    friend Base;
+
+public:
+    static constexpr int num_taps = NTAPS;
+    static constexpr int up_rate = UP;
+    // Taps per sub-filter
+    static constexpr int phase_len = (NTAPS + UP - 1) / UP;
+
+    UpfirLerpFixed()
+    {
+        Base::set_up_rate(UP);
+    }
+
+    // The shape is fixed, so only taps of length NTAPS are accepted
+    UpfirLerpFixed& set_up_taps(const T* const taps, size_t len, Symmetry symmetry = Symmetry::Detect)
+    {
+        if (len != static_cast<size_t>(NTAPS))
+            throw std::invalid_argument("expected " + std::to_string(NTAPS) + " taps, got " + std::to_string(len));
+
+        return Base::set_up_taps(taps, len, symmetry);
+    }
+
+    UpfirLerpFixed& set_up_taps(const std::vector<T> &taps, Symmetry symmetry = Symmetry::Detect)
+    {
+        return set_up_taps(taps.data(), taps.size(), symmetry);
+    }
+
+    UpfirLerpFixed& set_up_taps(std::vector<T> &&taps, Symmetry symmetry = Symmetry::Detect)
+    {
+        if (taps.size() != static_cast<size_t>(NTAPS))
+            throw std::invalid_argument("expected " + std::to_string(NTAPS) + " taps, got " + std::to_string(taps.size()));
+
+        return Base::set_up_taps(std::move(taps), symmetry);
+    }
+
+    UpfirLerpFixed& set_up_rate(int up)
+    {
+        if (up != UP)
+            throw std::invalid_argument("upsample rate is fixed at " + std::to_string(UP));
+
+        return *this;
+    }
+
+protected:
+    std::array<T, static_cast<size_t>(UP) * phase_len> m_fixed_bank{};
+
+    void bank_changed()
+    {
+        if (this->m_bank.size() == m_fixed_bank.size())
+            std::copy(this->m_bank.begin(), this->m_bank.end(), m_fixed_bank.begin());
+    }
+
+    std::complex<T> calculate_interrim_sample(
+        const index_t j,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const size_t in_offset = 0
+    ){
+        const int phase = static_cast<int>(j % UP);
+        const index_t j_in = j / UP;
+        const index_t start = j_in - phase_len + 1;
+
+        if (start < 0 || j_in >= static_cast<index_t>(in_length))
+            return Base::calculate_interrim_sample(j, in, in_length, in_offset);
+
+        UFL_STAT(this->thread_stats().interrim++;)
+        UFL_STAT(this->thread_stats().macs += phase_len;)
+
+        T re = 0, im = 0;
+        detail::UnrolledDot<T, TIn, 0, phase_len>::run(
+            m_fixed_bank.data() + static_cast<size_t>(phase) * phase_len,
+            in + (start - static_cast<index_t>(in_offset)),
+            re,
+            im
+        );
+        return std::complex<T>(re, im);
+    }
+};
+
+
+// Runtime-polymorphic view of a resampler, so that a filter shape only known at runtime
+// can still be served by a fixed specialisation; see make_upfirlerp().
+template <typename T, typename TIn = T>
+class Resampler
+{
+public:
+    virtual ~Resampler() = default;
+
+    virtual void interpolate_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t out_length,
+        std::complex<T>* out
+    ) = 0;
+
+    virtual void interpolate(
+        const std::vector<std::complex<TIn>> &in,
+        const double in_T,
+        const std::vector<double> &t,
+        std::vector<std::complex<T>> &out
+    ) = 0;
+
+    virtual void interpolate_uniform_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t out_length,
+        std::complex<T>* out
+    ) = 0;
+
+    virtual void set_threads(int threads) = 0;
+    virtual void set_time_order(TimeOrder order) = 0;
+
+    // Whether a fixed specialisation was picked
+    virtual bool is_fixed() const = 0;
+};
+
+template <typename Impl, typename T, typename TIn = T>
+class ResamplerImpl : public Resampler<T, TIn>
+{
+public:
+    ResamplerImpl(const std::vector<T> &taps, int up)
+    {
+        m_impl.set_up_rate(up).set_up_taps(taps);
+    }
+
+    void interpolate_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t out_length,
+        std::complex<T>* out
+    ) override
+    {
+        m_impl.interpolate_array(in, in_length, in_T, t, out_length, out);
+    }
+
+    void interpolate(
+        const std::vector<std::complex<TIn>> &in,
+        const double in_T,
+        const std::vector<double> &t,
+        std::vector<std::complex<T>> &out
+    ) override
+    {
+        m_impl.interpolate(in, in_T, t, out);
+    }
+
+    void interpolate_uniform_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t out_length,
+        std::complex<T>* out
+    ) override
+    {
+        m_impl.interpolate_uniform_array(in, in_length, in_T, t0, dt, out_length, out);
+    }
+
+    void set_threads(int threads) override
+    {
+        m_impl.set_threads(threads);
+    }
+
+    void set_time_order(TimeOrder order) override
+    {
+        m_impl.set_time_order(order);
+    }
+
+    bool is_fixed() const override
+    {
+        return !std::is_same<Impl, UpfirLerp<T, TIn>>::value;
+    }
+
+    // The underlying resampler, for settings not covered by the interface
+    Impl& get()
+    {
+        return m_impl;
+    }
+
+protected:
+    Impl m_impl;
+};
+
+
+// Filter shapes with a pre-instantiated specialisation
+template <int NTAPS, int UP>
+struct FixedConfig {};
+
+template <typename... Configs>
+struct FixedConfigs {};
+
+using DefaultFixedConfigs = FixedConfigs<
+    FixedConfig<64, 8>,
+    FixedConfig<128, 16>
+>;
+
+namespace detail
+{
+
+template <typename T, typename TIn, typename Configs>
+struct FixedRegistry;
+
+template <typename T, typename TIn>
+struct FixedRegistry<T, TIn, FixedConfigs<>>
+{
+    static std::unique_ptr<Resampler<T, TIn>> make(const std::vector<T> &taps, int up)
+    {
+        return std::unique_ptr<Resampler<T, TIn>>(new ResamplerImpl<UpfirLerp<T, TIn>, T, TIn>(taps, up));
+    }
+};
+
+template <typename T, typename TIn, int NTAPS, int UP, typename... Rest>
+struct FixedRegistry<T, TIn, FixedConfigs<FixedConfig<NTAPS, UP>, Rest...>>
+{
+    static std::unique_ptr<Resampler<T, TIn>> make(const std::vector<T> &taps, int up)
+    {
+        if (taps.size() == static_cast<size_t>(NTAPS) && up == UP)
+            return std::unique_ptr<Resampler<T, TIn>>(
+                new ResamplerImpl<UpfirLerpFixed<T, NTAPS, UP, TIn>, T, TIn>(taps, up));
+
+        return FixedRegistry<T, TIn, FixedConfigs<Rest...>>::make(taps, up);
+    }
+};
+
+} // namespace detail
+
+// Creates a resampler for the given taps and upsample rate.
+// Shapes listed in Configs get their fixed specialisation, anything else the generic UpfirLerp.
+template <typename T, typename TIn = T, typename Configs = DefaultFixedConfigs>
+std::unique_ptr<Resampler<T, TIn>> make_upfirlerp(const std::vector<T> &taps, int up)
+{
+    return detail::FixedRegistry<T, TIn, Configs>::make(taps, up);
+}
+
+}
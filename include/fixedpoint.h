@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+namespace ufl
+{
+namespace detail
+{
+
+// Full 64x64 -> 128 bit unsigned multiply; returns the high word and writes the low word
+inline uint64_t mul_64x64(uint64_t a, uint64_t b, uint64_t& lo)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+    lo = static_cast<uint64_t>(p);
+    return static_cast<uint64_t>(p >> 64);
+#else
+    const uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+
+    const uint64_t ll = a_lo * b_lo;
+    const uint64_t lh = a_lo * b_hi;
+    const uint64_t hl = a_hi * b_lo;
+    const uint64_t hh = a_hi * b_hi;
+
+    const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+    lo = (mid << 32) | (ll & 0xFFFFFFFFu);
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+// 64.64 fixed-point phase, whole + frac / 2^64.
+// Used as an accumulator so a uniform grid can be stepped without drift or per-sample division.
+struct Phase64
+{
+    int64_t whole = 0;
+    uint64_t frac = 0;
+
+    static Phase64 from_double(double x)
+    {
+        Phase64 p;
+        const double w = std::floor(x);
+        const double f = (x - w) * 18446744073709551616.0; // 2^64
+        p.whole = static_cast<int64_t>(w);
+        p.frac = f >= 18446744073709551616.0 ? UINT64_MAX : static_cast<uint64_t>(f);
+        return p;
+    }
+
+    void add(const Phase64& step)
+    {
+        const uint64_t f = frac + step.frac;
+        whole += step.whole + (f < frac ? 1 : 0);
+        frac = f;
+    }
+
+    // Exactly this + n * step, as if add() had been called n times
+    Phase64 advanced(const Phase64& step, uint64_t n) const
+    {
+        uint64_t lo;
+        const uint64_t hi = mul_64x64(step.frac, n, lo);
+
+        Phase64 p;
+        p.frac = frac + lo;
+        p.whole = whole + step.whole * static_cast<int64_t>(n) + static_cast<int64_t>(hi) + (p.frac < frac ? 1 : 0);
+        return p;
+    }
+
+    // Fractional part in [0, 1]
+    double fraction() const
+    {
+        return static_cast<double>(frac) * 0x1p-64;
+    }
+};
+
+} // namespace detail
+
+// Exact time for the fixed-point interpolate_array() overload: a position in input samples,
+// whole + frac / 2^64, e.g. FixedTime::from_double(t / in_T).
+using FixedTime = detail::Phase64;
+
+} // namespace ufl
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "fft.h"
+
+namespace ufl
+{
+
+// Overlap-save engine for long filters.
+// Interrim sample j = m * up + p is sub-filter p convolved with the input at position m, so a block of
+// consecutive positions is one circular convolution per phase. The input block is transformed once and
+// shared by all up phases; each multiplies it by its sub-filter's spectrum and transforms back.
+// That is O(log size) work per interrim sample instead of the phase_len multiplies of a dot product.
+// configure() must not run concurrently with anything; run() may, given a Workspace per thread.
+template <typename T>
+class OverlapSave
+{
+public:
+    // Buffers of one run() at a time
+    struct Workspace
+    {
+        std::vector<std::complex<T>> x;     // spectrum of the input block
+        std::vector<std::complex<T>> y;     // one phase at a time
+    };
+
+    // Spectra of the up sub-filters of bank, phase_len taps each, stored reversed and zero-padded
+    // at the front as in BaseUpfirLerp
+    void configure(const T* const bank, const int up, const int phase_len)
+    {
+        m_up = up;
+        m_phase_len = phase_len;
+
+        // The transform size with the least work per valid position, n log n / (n - phase_len + 1)
+        size_t n = 2;
+        while (n < 2 * static_cast<size_t>(phase_len))
+            n <<= 1;
+        while (work(2 * n) < work(n))
+            n <<= 1;
+        m_fft.resize(n);
+
+        // The inverse transform's 1 / n is folded into the spectra
+        m_spectra.assign(static_cast<size_t>(up) * n, std::complex<T>(0));
+        for (int p = 0; p < up; p++)
+        {
+            std::complex<T>* spectrum = m_spectra.data() + static_cast<size_t>(p) * n;
+            for (int q = 0; q < phase_len; q++)
+                spectrum[q] = bank[static_cast<size_t>(p) * phase_len + phase_len - 1 - q] / static_cast<T>(n);
+            m_fft.forward(spectrum);
+        }
+    }
+
+    void clear()
+    {
+        m_phase_len = 0;
+        m_spectra.clear();
+        m_spectra.shrink_to_fit();
+    }
+
+    bool ready() const
+    {
+        return m_phase_len > 0;
+    }
+
+    // Transform size
+    size_t size() const
+    {
+        return m_fft.size();
+    }
+
+    // Input positions per block, each worth up interrim samples
+    size_t block() const
+    {
+        return m_fft.size() - m_phase_len + 1;
+    }
+
+    // Blocks run() takes for count interrim samples from j0 on
+    size_t blocks(const int64_t j0, const size_t count) const
+    {
+        const int64_t positions = (j0 + static_cast<int64_t>(count) - 1) / m_up - j0 / m_up + 1;
+        return static_cast<size_t>((positions + static_cast<int64_t>(block()) - 1) / static_cast<int64_t>(block()));
+    }
+
+    // Interrim samples [j0, j0 + count) into xj, for j0 >= 0, treating the input as zero outside [0, in_length)
+    template <typename TIn>
+    void run(
+        const int64_t j0,
+        const size_t count,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        std::complex<T>* const xj,
+        Workspace& ws
+    ) const
+    {
+        const size_t n = m_fft.size();
+        const int64_t valid = static_cast<int64_t>(block());
+        const int64_t jend = j0 + static_cast<int64_t>(count);
+        const int64_t length = static_cast<int64_t>(in_length);
+        ws.x.resize(n);
+        ws.y.resize(n);
+
+        for (int64_t mb = j0 / m_up; mb * m_up < jend; mb += valid)
+        {
+            // Input positions [mb - phase_len + 1, mb + valid), zero outside the signal
+            const int64_t first = mb - m_phase_len + 1;
+            const int64_t lo = std::min(std::max(-first, int64_t(0)), static_cast<int64_t>(n));
+            const int64_t hi = std::max(std::min(length - first, static_cast<int64_t>(n)), lo);
+            std::fill(ws.x.begin(), ws.x.begin() + lo, std::complex<T>(0));
+            for (int64_t i = lo; i < hi; i++)
+                ws.x[i] = std::complex<T>(static_cast<T>(in[first + i].real()), static_cast<T>(in[first + i].imag()));
+            std::fill(ws.x.begin() + hi, ws.x.end(), std::complex<T>(0));
+            m_fft.forward(ws.x.data());
+
+            for (int p = 0; p < m_up; p++)
+            {
+                // Positions of this block whose phase p sample is asked for
+                const int64_t mlo = std::max(mb, ceil_div(j0 - p));
+                const int64_t mhi = std::min(mb + valid, ceil_div(jend - p));
+                if (mlo >= mhi)
+                    continue;
+
+                const T* x = reinterpret_cast<const T*>(ws.x.data());
+                const T* h = reinterpret_cast<const T*>(m_spectra.data() + static_cast<size_t>(p) * n);
+                T* y = reinterpret_cast<T*>(ws.y.data());
+                for (size_t i = 0; i < n; i++)
+                {
+                    y[2 * i] = x[2 * i] * h[2 * i] - x[2 * i + 1] * h[2 * i + 1];
+                    y[2 * i + 1] = x[2 * i] * h[2 * i + 1] + x[2 * i + 1] * h[2 * i];
+                }
+                m_fft.inverse(ws.y.data());
+
+                // Output i of the circular convolution is position first + i, valid from phase_len - 1 on
+                for (int64_t m = mlo; m < mhi; m++)
+                    xj[m * m_up + p - j0] = ws.y[m - first];
+            }
+        }
+    }
+
+protected:
+    int m_up = 1;
+    int m_phase_len = 0;
+    Fft<T> m_fft;
+    std::vector<std::complex<T>> m_spectra;     // phase p at [p * size(), (p + 1) * size())
+
+    double work(const size_t n) const
+    {
+        return static_cast<double>(n) * std::log2(static_cast<double>(n)) / static_cast<double>(n - m_phase_len + 1);
+    }
+
+    // Smallest position m with m * up >= a
+    int64_t ceil_div(const int64_t a) const
+    {
+        return a >= 0 ? (a + m_up - 1) / m_up : -((-a) / m_up);
+    }
+};
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Hint that p will be written soon
+#if defined(__GNUC__)
+#define UFL_PREFETCH(p) __builtin_prefetch((p), 1)
+#else
+#define UFL_PREFETCH(p)
+#endif
+
+namespace ufl
+{
+namespace detail
+{
+
+// Per-thread buffers of the reordering strategy, kept between calls
+// so that sorting a large chunk does not allocate every time
+template <typename T>
+struct ReorderScratch
+{
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> spare;
+    std::vector<std::complex<T>> outputs;   // in chunk order, when an epilogue op needs them in order
+    std::vector<size_t> count;              // digit counts of the sort
+    std::vector<size_t> starts;             // bucket starts of the sort
+};
+
+// Number of bits needed to hold v
+inline int bit_width(uint64_t v)
+{
+    int bits = 0;
+    for (; v; v >>= 1)
+        bits++;
+    return bits;
+}
+
+// One stable counting pass: src[0, n) into dst by bits [shift, shift + width) of the keys.
+// count needs 2^width entries; if starts is given, it receives the first position of every digit.
+inline void radix_pass(const uint64_t* src, uint64_t* dst, const size_t n, const int shift, const int width,
+                       std::vector<size_t>& count, std::vector<size_t>* starts = nullptr)
+{
+    const uint64_t mask = (uint64_t(1) << width) - 1;
+    std::fill(count.begin(), count.begin() + (size_t(1) << width), 0);
+    for (size_t i = 0; i < n; i++)
+        count[(src[i] >> shift) & mask]++;
+
+    size_t sum = 0;
+    for (size_t d = 0; d <= mask; d++)
+    {
+        const size_t c = count[d];
+        count[d] = sum;
+        sum += c;
+    }
+    if (starts)
+        starts->assign(count.begin(), count.begin() + (size_t(1) << width));
+
+    for (size_t i = 0; i < n; i++)
+        dst[count[(src[i] >> shift) & mask]++] = src[i];
+}
+
+// Digits of the radix sort: at most max_radix_digit bits per pass, and max_radix_top for the first
+constexpr int max_radix_digit = 11;
+constexpr int max_radix_top = 8;
+
+// Stable radix sort of keys by their bits [lo, hi); spare, count and starts are scratch of any size.
+// The top bits go first, into buckets of a few thousand keys, and each bucket is then sorted
+// least significant digit first while it sits in cache. Every pass over the whole array thus
+// writes to at most 256 places, which keeps it clear of TLB and cache thrashing on large chunks.
+inline void radix_sort(std::vector<uint64_t>& keys, std::vector<uint64_t>& spare, const int lo, const int hi,
+                       std::vector<size_t>& count, std::vector<size_t>& starts)
+{
+    constexpr size_t bucket_keys = 8192;
+    if (hi <= lo)
+        return;
+
+    const size_t n = keys.size();
+    spare.resize(n);
+    count.resize(size_t(1) << max_radix_digit);
+
+    int top = 0;
+    while (top < max_radix_top && top < hi - lo && (n >> top) > bucket_keys)
+        top++;
+    top = std::max(top, 1);
+
+    radix_pass(keys.data(), spare.data(), n, hi - top, top, count, &starts);
+    starts.push_back(n);
+
+    // The rest of the bits within each bucket, in passes of at most max_radix_digit bits
+    const int rest = hi - top - lo;
+    const int passes = (rest + max_radix_digit - 1) / max_radix_digit;
+    const int digit = passes ? (rest + passes - 1) / passes : 0;
+    for (size_t b = 0; b + 1 < starts.size(); b++)
+    {
+        uint64_t* src = spare.data() + starts[b];
+        uint64_t* dst = keys.data() + starts[b];
+        const size_t len = starts[b + 1] - starts[b];
+        for (int shift = lo; shift < hi - top; shift += digit)
+        {
+            radix_pass(src, dst, len, shift, std::min(digit, hi - top - shift), count);
+            std::swap(src, dst);
+        }
+    }
+
+    // Every bucket made the same number of passes, so all of them ended up in the same buffer
+    if (passes % 2 == 0)
+        keys.swap(spare);
+}
+
+inline void radix_sort(std::vector<uint64_t>& keys, std::vector<uint64_t>& spare, const int lo, const int hi)
+{
+    std::vector<size_t> count, starts;
+    radix_sort(keys, spare, lo, hi, count, starts);
+}
+
+} // namespace detail
+} // namespace ufl
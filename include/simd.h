@@ -0,0 +1,777 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+// Vectorised real-taps by complex-input dot products, picked at runtime.
+// Define UFL_NO_SIMD to build only the scalar path.
+#if !defined(UFL_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UFL_SIMD_X86
+#include <immintrin.h>
+#elif !defined(UFL_NO_SIMD) && defined(__aarch64__)
+#define UFL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace ufl
+{
+namespace simd
+{
+
+enum class Isa
+{
+    Scalar,
+    Avx2,
+    Avx512,
+    Neon
+};
+
+inline const char* isa_name(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Avx2: return "avx2";
+        case Isa::Avx512: return "avx512";
+        case Isa::Neon: return "neon";
+        default: return "scalar";
+    }
+}
+
+// Best instruction set this CPU supports; only checked once per process
+inline Isa detect_isa()
+{
+    static const Isa isa = []{
+#if defined(UFL_SIMD_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return Isa::Avx512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return Isa::Avx2;
+#elif defined(UFL_SIMD_NEON)
+        return Isa::Neon;
+#endif
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+inline bool isa_supported(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar: return true;
+        case Isa::Avx2: return detect_isa() == Isa::Avx2 || detect_isa() == Isa::Avx512;
+        default: return detect_isa() == isa;
+    }
+}
+
+// Computes sum(taps[i] * in[i]) for i in [0, n).
+// The input may be a narrower type than the taps, e.g. 16-bit IQ, which is widened to T as it is read.
+template <typename T, typename TIn = T>
+using DotFn = std::complex<T> (*)(const T* taps, const std::complex<TIn>* in, size_t n);
+
+template <typename T, typename TIn = T>
+inline std::complex<T> dot_scalar(const T* taps, const std::complex<TIn>* in, size_t n)
+{
+    std::complex<T> acc = {0, 0};
+    for (size_t i = 0; i < n; i++)
+        acc += std::complex<T>(static_cast<T>(in[i].real()), static_cast<T>(in[i].imag())) * taps[i];
+    return acc;
+}
+
+// The same dot product for taps that mirror themselves, taps[i] == sign * taps[n - 1 - i] with sign +1 or -1.
+// Mirrored input pairs are added before the multiply, so only the first half of the taps is read
+// and half the multiplies are done.
+template <typename T, typename TIn = T>
+using FoldFn = std::complex<T> (*)(const T* taps, const std::complex<TIn>* in, size_t n, T sign);
+
+template <typename T, typename TIn = T>
+inline std::complex<T> fold_scalar(const T* taps, const std::complex<TIn>* in, size_t n, T sign)
+{
+    const size_t half = n / 2;
+    T re = 0, im = 0;
+    for (size_t i = 0; i < half; i++)
+    {
+        re += (static_cast<T>(in[i].real()) + sign * static_cast<T>(in[n - 1 - i].real())) * taps[i];
+        im += (static_cast<T>(in[i].imag()) + sign * static_cast<T>(in[n - 1 - i].imag())) * taps[i];
+    }
+    if (n % 2)
+    {
+        re += static_cast<T>(in[half].real()) * taps[half];
+        im += static_cast<T>(in[half].imag()) * taps[half];
+    }
+    return std::complex<T>(re, im);
+}
+
+#if defined(UFL_SIMD_X86)
+
+// Each kernel broadcasts every real tap to both halves of its complex sample,
+// then multiply-accumulates against the interleaved input directly.
+// The even lanes of the accumulator sum the real parts, the odd lanes the imaginary parts.
+
+__attribute__((target("avx2,fma")))
+inline std::complex<float> dot_avx2(const float* taps, const std::complex<float>* in, size_t n)
+{
+    const float* x = reinterpret_cast<const float*>(in);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 t = _mm256_loadu_ps(taps + i);
+        __m256 lo = _mm256_unpacklo_ps(t, t); // t0 t0 t1 t1 | t4 t4 t5 t5
+        __m256 hi = _mm256_unpackhi_ps(t, t); // t2 t2 t3 t3 | t6 t6 t7 t7
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + 2 * i), _mm256_permute2f128_ps(lo, hi, 0x20), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + 2 * i + 8), _mm256_permute2f128_ps(lo, hi, 0x31), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    std::complex<float> acc = {_mm_cvtss_f32(s), _mm_cvtss_f32(_mm_shuffle_ps(s, s, 1))};
+
+    for (; i < n; i++)
+        acc += in[i] * taps[i];
+    return acc;
+}
+
+__attribute__((target("avx2,fma")))
+inline std::complex<double> dot_avx2(const double* taps, const std::complex<double>* in, size_t n)
+{
+    const double* x = reinterpret_cast<const double*>(in);
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d t = _mm256_loadu_pd(taps + i);
+        __m256d lo = _mm256_unpacklo_pd(t, t); // t0 t0 | t2 t2
+        __m256d hi = _mm256_unpackhi_pd(t, t); // t1 t1 | t3 t3
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + 2 * i), _mm256_permute2f128_pd(lo, hi, 0x20), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + 2 * i + 4), _mm256_permute2f128_pd(lo, hi, 0x31), acc1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    std::complex<double> acc = {_mm_cvtsd_f64(s), _mm_cvtsd_f64(_mm_unpackhi_pd(s, s))};
+
+    for (; i < n; i++)
+        acc += in[i] * taps[i];
+    return acc;
+}
+
+__attribute__((target("avx512f")))
+inline std::complex<float> dot_avx512(const float* taps, const std::complex<float>* in, size_t n)
+{
+    const float* x = reinterpret_cast<const float*>(in);
+    const __m512i dup_lo = _mm512_set_epi32(7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+    const __m512i dup_hi = _mm512_set_epi32(15, 15, 14, 14, 13, 13, 12, 12, 11, 11, 10, 10, 9, 9, 8, 8);
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 t = _mm512_loadu_ps(taps + i);
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + 2 * i), _mm512_maskz_permutexvar_ps(0xFFFF, dup_lo, t), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + 2 * i + 16), _mm512_maskz_permutexvar_ps(0xFFFF, dup_hi, t), acc1);
+    }
+    if (i + 8 <= n)
+    {
+        __m512 t = _mm512_maskz_loadu_ps(0x00FF, taps + i);
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + 2 * i), _mm512_maskz_permutexvar_ps(0xFFFF, dup_lo, t), acc0);
+        i += 8;
+    }
+    acc0 = _mm512_add_ps(acc0, acc1);
+
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, acc0);
+    std::complex<float> acc = {0, 0};
+    for (int l = 0; l < 16; l += 2)
+        acc += std::complex<float>(lanes[l], lanes[l + 1]);
+
+    for (; i < n; i++)
+        acc += in[i] * taps[i];
+    return acc;
+}
+
+__attribute__((target("avx512f")))
+inline std::complex<double> dot_avx512(const double* taps, const std::complex<double>* in, size_t n)
+{
+    const double* x = reinterpret_cast<const double*>(in);
+    const __m512i dup_lo = _mm512_set_epi64(3, 3, 2, 2, 1, 1, 0, 0);
+    const __m512i dup_hi = _mm512_set_epi64(7, 7, 6, 6, 5, 5, 4, 4);
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512d t = _mm512_loadu_pd(taps + i);
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + 2 * i), _mm512_maskz_permutexvar_pd(0xFF, dup_lo, t), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + 2 * i + 8), _mm512_maskz_permutexvar_pd(0xFF, dup_hi, t), acc1);
+    }
+    if (i + 4 <= n)
+    {
+        __m512d t = _mm512_maskz_loadu_pd(0x0F, taps + i);
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + 2 * i), _mm512_maskz_permutexvar_pd(0xFF, dup_lo, t), acc0);
+        i += 4;
+    }
+    acc0 = _mm512_add_pd(acc0, acc1);
+
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, acc0);
+    std::complex<double> acc = {0, 0};
+    for (int l = 0; l < 8; l += 2)
+        acc += std::complex<double>(lanes[l], lanes[l + 1]);
+
+    for (; i < n; i++)
+        acc += in[i] * taps[i];
+    return acc;
+}
+
+// Integer IQ: the same tap layout, with each block of input sign-extended to 32 bits
+// and converted to float in registers, so the capture is never widened in memory.
+
+__attribute__((target("avx2,fma")))
+inline __m256 widen_avx2(const int16_t* x)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x))));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256 widen_avx2(const int8_t* x)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(x))));
+}
+
+template <typename TIn>
+__attribute__((target("avx2,fma")))
+inline std::complex<float> dot_avx2_widen(const float* taps, const std::complex<TIn>* in, size_t n)
+{
+    const TIn* x = reinterpret_cast<const TIn*>(in);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 t = _mm256_loadu_ps(taps + i);
+        __m256 lo = _mm256_unpacklo_ps(t, t);
+        __m256 hi = _mm256_unpackhi_ps(t, t);
+        acc0 = _mm256_fmadd_ps(widen_avx2(x + 2 * i), _mm256_permute2f128_ps(lo, hi, 0x20), acc0);
+        acc1 = _mm256_fmadd_ps(widen_avx2(x + 2 * i + 8), _mm256_permute2f128_ps(lo, hi, 0x31), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    std::complex<float> acc = {_mm_cvtss_f32(s), _mm_cvtss_f32(_mm_shuffle_ps(s, s, 1))};
+
+    for (; i < n; i++)
+        acc += std::complex<float>(in[i].real(), in[i].imag()) * taps[i];
+    return acc;
+}
+
+__attribute__((target("avx512f")))
+inline __m512 widen_avx512(const int16_t* x)
+{
+    return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_cvtepi16_epi32(0xFFFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x))));
+}
+
+__attribute__((target("avx512f")))
+inline __m512 widen_avx512(const int8_t* x)
+{
+    return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_cvtepi8_epi32(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i*>(x))));
+}
+
+template <typename TIn>
+__attribute__((target("avx512f")))
+inline std::complex<float> dot_avx512_widen(const float* taps, const std::complex<TIn>* in, size_t n)
+{
+    const TIn* x = reinterpret_cast<const TIn*>(in);
+    const __m512i dup_lo = _mm512_set_epi32(7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+    const __m512i dup_hi = _mm512_set_epi32(15, 15, 14, 14, 13, 13, 12, 12, 11, 11, 10, 10, 9, 9, 8, 8);
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 t = _mm512_loadu_ps(taps + i);
+        acc0 = _mm512_fmadd_ps(widen_avx512(x + 2 * i), _mm512_maskz_permutexvar_ps(0xFFFF, dup_lo, t), acc0);
+        acc1 = _mm512_fmadd_ps(widen_avx512(x + 2 * i + 16), _mm512_maskz_permutexvar_ps(0xFFFF, dup_hi, t), acc1);
+    }
+    if (i + 8 <= n)
+    {
+        __m512 t = _mm512_maskz_loadu_ps(0x00FF, taps + i);
+        acc0 = _mm512_fmadd_ps(widen_avx512(x + 2 * i), _mm512_maskz_permutexvar_ps(0xFFFF, dup_lo, t), acc0);
+        i += 8;
+    }
+    acc0 = _mm512_add_ps(acc0, acc1);
+
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, acc0);
+    std::complex<float> acc = {0, 0};
+    for (int l = 0; l < 16; l += 2)
+        acc += std::complex<float>(lanes[l], lanes[l + 1]);
+
+    for (; i < n; i++)
+        acc += std::complex<float>(in[i].real(), in[i].imag()) * taps[i];
+    return acc;
+}
+
+// Folded kernels: each block of input from the front is paired with the block mirroring it from the back,
+// whose complex samples are reversed in registers, before the usual multiply-accumulate.
+
+__attribute__((target("avx2,fma")))
+inline __m256 load_avx2(const float* x)
+{
+    return _mm256_loadu_ps(x);
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256 load_avx2(const int16_t* x)
+{
+    return widen_avx2(x);
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256 load_avx2(const int8_t* x)
+{
+    return widen_avx2(x);
+}
+
+// Four complex floats in reverse order
+__attribute__((target("avx2,fma")))
+inline __m256 reverse_avx2(__m256 v)
+{
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v), 0x1B));
+}
+
+template <typename TIn>
+__attribute__((target("avx2,fma")))
+inline std::complex<float> fold_avx2(const float* taps, const std::complex<TIn>* in, size_t n, float sign)
+{
+    const TIn* x = reinterpret_cast<const TIn*>(in);
+    const __m256 s = _mm256_set1_ps(sign);
+    const size_t half = n / 2;
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= half; i += 8)
+    {
+        __m256 t = _mm256_loadu_ps(taps + i);
+        __m256 lo = _mm256_unpacklo_ps(t, t);
+        __m256 hi = _mm256_unpackhi_ps(t, t);
+        // in[n - 8 - i, n - 4 - i) mirrors taps i + 4 to i + 7, in[n - 4 - i, n - i) taps i to i + 3
+        __m256 x0 = _mm256_fmadd_ps(reverse_avx2(load_avx2(x + 2 * (n - 4 - i))), s, load_avx2(x + 2 * i));
+        __m256 x1 = _mm256_fmadd_ps(reverse_avx2(load_avx2(x + 2 * (n - 8 - i))), s, load_avx2(x + 2 * i + 8));
+        acc0 = _mm256_fmadd_ps(x0, _mm256_permute2f128_ps(lo, hi, 0x20), acc0);
+        acc1 = _mm256_fmadd_ps(x1, _mm256_permute2f128_ps(lo, hi, 0x31), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+
+    __m128 r = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    r = _mm_add_ps(r, _mm_movehl_ps(r, r));
+    std::complex<float> acc = {_mm_cvtss_f32(r), _mm_cvtss_f32(_mm_shuffle_ps(r, r, 1))};
+
+    // The rest of the pairs, and the middle tap of an odd length
+    return acc + fold_scalar(taps + i, in + i, n - 2 * i, sign);
+}
+
+__attribute__((target("avx2,fma")))
+inline std::complex<double> fold_avx2(const double* taps, const std::complex<double>* in, size_t n, double sign)
+{
+    const double* x = reinterpret_cast<const double*>(in);
+    const __m256d s = _mm256_set1_pd(sign);
+    const size_t half = n / 2;
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= half; i += 4)
+    {
+        __m256d t = _mm256_loadu_pd(taps + i);
+        __m256d lo = _mm256_unpacklo_pd(t, t);
+        __m256d hi = _mm256_unpackhi_pd(t, t);
+        __m256d b0 = _mm256_loadu_pd(x + 2 * (n - 2 - i));
+        __m256d b1 = _mm256_loadu_pd(x + 2 * (n - 4 - i));
+        __m256d x0 = _mm256_fmadd_pd(_mm256_permute2f128_pd(b0, b0, 0x01), s, _mm256_loadu_pd(x + 2 * i));
+        __m256d x1 = _mm256_fmadd_pd(_mm256_permute2f128_pd(b1, b1, 0x01), s, _mm256_loadu_pd(x + 2 * i + 4));
+        acc0 = _mm256_fmadd_pd(x0, _mm256_permute2f128_pd(lo, hi, 0x20), acc0);
+        acc1 = _mm256_fmadd_pd(x1, _mm256_permute2f128_pd(lo, hi, 0x31), acc1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+
+    __m128d r = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    std::complex<double> acc = {_mm_cvtsd_f64(r), _mm_cvtsd_f64(_mm_unpackhi_pd(r, r))};
+
+    return acc + fold_scalar(taps + i, in + i, n - 2 * i, sign);
+}
+
+__attribute__((target("avx512f")))
+inline __m512 load_avx512(const float* x)
+{
+    return _mm512_loadu_ps(x);
+}
+
+__attribute__((target("avx512f")))
+inline __m512 load_avx512(const int16_t* x)
+{
+    return widen_avx512(x);
+}
+
+__attribute__((target("avx512f")))
+inline __m512 load_avx512(const int8_t* x)
+{
+    return widen_avx512(x);
+}
+
+template <typename TIn>
+__attribute__((target("avx512f")))
+inline std::complex<float> fold_avx512(const float* taps, const std::complex<TIn>* in, size_t n, float sign)
+{
+    const TIn* x = reinterpret_cast<const TIn*>(in);
+    const __m512i dup_lo = _mm512_set_epi32(7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+    const __m512i dup_hi = _mm512_set_epi32(15, 15, 14, 14, 13, 13, 12, 12, 11, 11, 10, 10, 9, 9, 8, 8);
+    const __m512i reverse = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512 s = _mm512_set1_ps(sign);
+    const size_t half = n / 2;
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= half; i += 16)
+    {
+        __m512 t = _mm512_loadu_ps(taps + i);
+        __m512 b0 = _mm512_castpd_ps(_mm512_maskz_permutexvar_pd(0xFF, reverse, _mm512_castps_pd(load_avx512(x + 2 * (n - 8 - i)))));
+        __m512 b1 = _mm512_castpd_ps(_mm512_maskz_permutexvar_pd(0xFF, reverse, _mm512_castps_pd(load_avx512(x + 2 * (n - 16 - i)))));
+        acc0 = _mm512_fmadd_ps(_mm512_fmadd_ps(b0, s, load_avx512(x + 2 * i)), _mm512_maskz_permutexvar_ps(0xFFFF, dup_lo, t), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_fmadd_ps(b1, s, load_avx512(x + 2 * i + 16)), _mm512_maskz_permutexvar_ps(0xFFFF, dup_hi, t), acc1);
+    }
+    acc0 = _mm512_add_ps(acc0, acc1);
+
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, acc0);
+    std::complex<float> acc = {0, 0};
+    for (int l = 0; l < 16; l += 2)
+        acc += std::complex<float>(lanes[l], lanes[l + 1]);
+
+    return acc + fold_scalar(taps + i, in + i, n - 2 * i, sign);
+}
+
+__attribute__((target("avx512f")))
+inline std::complex<double> fold_avx512(const double* taps, const std::complex<double>* in, size_t n, double sign)
+{
+    const double* x = reinterpret_cast<const double*>(in);
+    const __m512i dup_lo = _mm512_set_epi64(3, 3, 2, 2, 1, 1, 0, 0);
+    const __m512i dup_hi = _mm512_set_epi64(7, 7, 6, 6, 5, 5, 4, 4);
+    const __m512d s = _mm512_set1_pd(sign);
+    const size_t half = n / 2;
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= half; i += 8)
+    {
+        __m512d t = _mm512_loadu_pd(taps + i);
+        __m512d b0 = _mm512_loadu_pd(x + 2 * (n - 4 - i));
+        __m512d b1 = _mm512_loadu_pd(x + 2 * (n - 8 - i));
+        b0 = _mm512_maskz_shuffle_f64x2(0xFF, b0, b0, 0x1B);
+        b1 = _mm512_maskz_shuffle_f64x2(0xFF, b1, b1, 0x1B);
+        acc0 = _mm512_fmadd_pd(_mm512_fmadd_pd(b0, s, _mm512_loadu_pd(x + 2 * i)), _mm512_maskz_permutexvar_pd(0xFF, dup_lo, t), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_fmadd_pd(b1, s, _mm512_loadu_pd(x + 2 * i + 8)), _mm512_maskz_permutexvar_pd(0xFF, dup_hi, t), acc1);
+    }
+    acc0 = _mm512_add_pd(acc0, acc1);
+
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, acc0);
+    std::complex<double> acc = {0, 0};
+    for (int l = 0; l < 8; l += 2)
+        acc += std::complex<double>(lanes[l], lanes[l + 1]);
+
+    return acc + fold_scalar(taps + i, in + i, n - 2 * i, sign);
+}
+
+#endif // UFL_SIMD_X86
+
+#if defined(UFL_SIMD_NEON)
+
+inline std::complex<float> dot_neon(const float* taps, const std::complex<float>* in, size_t n)
+{
+    const float* x = reinterpret_cast<const float*>(in);
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t t = vld1q_f32(taps + i);
+        acc0 = vfmaq_f32(acc0, vld1q_f32(x + 2 * i), vzip1q_f32(t, t));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(x + 2 * i + 4), vzip2q_f32(t, t));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+
+    float32x2_t s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    std::complex<float> acc = {vget_lane_f32(s, 0), vget_lane_f32(s, 1)};
+
+    for (; i < n; i++)
+        acc += in[i] * taps[i];
+    return acc;
+}
+
+inline std::complex<double> dot_neon(const double* taps, const std::complex<double>* in, size_t n)
+{
+    const double* x = reinterpret_cast<const double*>(in);
+    float64x2_t acc0 = vdupq_n_f64(0);
+    float64x2_t acc1 = vdupq_n_f64(0);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        float64x2_t t = vld1q_f64(taps + i);
+        acc0 = vfmaq_f64(acc0, vld1q_f64(x + 2 * i), vzip1q_f64(t, t));
+        acc1 = vfmaq_f64(acc1, vld1q_f64(x + 2 * i + 2), vzip2q_f64(t, t));
+    }
+    acc0 = vaddq_f64(acc0, acc1);
+
+    std::complex<double> acc = {vgetq_lane_f64(acc0, 0), vgetq_lane_f64(acc0, 1)};
+
+    for (; i < n; i++)
+        acc += in[i] * taps[i];
+    return acc;
+}
+
+// Integer IQ, widened to float in registers
+inline float32x4x2_t widen_neon(const int16_t* x)
+{
+    int16x8_t v = vld1q_s16(x);
+    return {{vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)))}};
+}
+
+inline float32x4x2_t widen_neon(const int8_t* x)
+{
+    int16x8_t v = vmovl_s8(vld1_s8(x));
+    return {{vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)))}};
+}
+
+template <typename TIn>
+inline std::complex<float> dot_neon_widen(const float* taps, const std::complex<TIn>* in, size_t n)
+{
+    const TIn* x = reinterpret_cast<const TIn*>(in);
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t t = vld1q_f32(taps + i);
+        float32x4x2_t v = widen_neon(x + 2 * i);
+        acc0 = vfmaq_f32(acc0, v.val[0], vzip1q_f32(t, t));
+        acc1 = vfmaq_f32(acc1, v.val[1], vzip2q_f32(t, t));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+
+    float32x2_t s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    std::complex<float> acc = {vget_lane_f32(s, 0), vget_lane_f32(s, 1)};
+
+    for (; i < n; i++)
+        acc += std::complex<float>(in[i].real(), in[i].imag()) * taps[i];
+    return acc;
+}
+
+// Folded kernels, as on x86
+inline float32x4x2_t load_neon(const float* x)
+{
+    return {{vld1q_f32(x), vld1q_f32(x + 4)}};
+}
+
+inline float32x4x2_t load_neon(const int16_t* x)
+{
+    return widen_neon(x);
+}
+
+inline float32x4x2_t load_neon(const int8_t* x)
+{
+    return widen_neon(x);
+}
+
+template <typename TIn>
+inline std::complex<float> fold_neon(const float* taps, const std::complex<TIn>* in, size_t n, float sign)
+{
+    const TIn* x = reinterpret_cast<const TIn*>(in);
+    const float32x4_t s = vdupq_n_f32(sign);
+    const size_t half = n / 2;
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+
+    size_t i = 0;
+    for (; i + 4 <= half; i += 4)
+    {
+        float32x4_t t = vld1q_f32(taps + i);
+        float32x4x2_t f = load_neon(x + 2 * i);
+        float32x4x2_t b = load_neon(x + 2 * (n - 4 - i));
+        float32x4_t x0 = vfmaq_f32(f.val[0], vextq_f32(b.val[1], b.val[1], 2), s);
+        float32x4_t x1 = vfmaq_f32(f.val[1], vextq_f32(b.val[0], b.val[0], 2), s);
+        acc0 = vfmaq_f32(acc0, x0, vzip1q_f32(t, t));
+        acc1 = vfmaq_f32(acc1, x1, vzip2q_f32(t, t));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+
+    float32x2_t r = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    std::complex<float> acc = {vget_lane_f32(r, 0), vget_lane_f32(r, 1)};
+
+    return acc + fold_scalar(taps + i, in + i, n - 2 * i, sign);
+}
+
+inline std::complex<double> fold_neon(const double* taps, const std::complex<double>* in, size_t n, double sign)
+{
+    const double* x = reinterpret_cast<const double*>(in);
+    const float64x2_t s = vdupq_n_f64(sign);
+    const size_t half = n / 2;
+    float64x2_t acc0 = vdupq_n_f64(0);
+    float64x2_t acc1 = vdupq_n_f64(0);
+
+    size_t i = 0;
+    for (; i + 2 <= half; i += 2)
+    {
+        float64x2_t t = vld1q_f64(taps + i);
+        float64x2_t x0 = vfmaq_f64(vld1q_f64(x + 2 * i), vld1q_f64(x + 2 * (n - 1 - i)), s);
+        float64x2_t x1 = vfmaq_f64(vld1q_f64(x + 2 * i + 2), vld1q_f64(x + 2 * (n - 2 - i)), s);
+        acc0 = vfmaq_f64(acc0, x0, vzip1q_f64(t, t));
+        acc1 = vfmaq_f64(acc1, x1, vzip2q_f64(t, t));
+    }
+    acc0 = vaddq_f64(acc0, acc1);
+
+    std::complex<double> acc = {vgetq_lane_f64(acc0, 0), vgetq_lane_f64(acc0, 1)};
+
+    return acc + fold_scalar(taps + i, in + i, n - 2 * i, sign);
+}
+
+#endif // UFL_SIMD_NEON
+
+// Kernel lookup; types without vectorised kernels always get the scalar path
+template <typename T, typename TIn = T>
+struct Kernels
+{
+    static DotFn<T, TIn> dot(Isa)
+    {
+        return &dot_scalar<T, TIn>;
+    }
+
+    static FoldFn<T, TIn> fold(Isa)
+    {
+        return &fold_scalar<T, TIn>;
+    }
+};
+
+// Float taps over 16-bit or 8-bit IQ
+template <typename TIn>
+struct WidenKernels
+{
+    static DotFn<float, TIn> dot(Isa isa)
+    {
+        switch (isa)
+        {
+#if defined(UFL_SIMD_X86)
+            case Isa::Avx2: return &dot_avx2_widen<TIn>;
+            case Isa::Avx512: return &dot_avx512_widen<TIn>;
+#elif defined(UFL_SIMD_NEON)
+            case Isa::Neon: return &dot_neon_widen<TIn>;
+#endif
+            default: return &dot_scalar<float, TIn>;
+        }
+    }
+
+    static FoldFn<float, TIn> fold(Isa isa)
+    {
+        switch (isa)
+        {
+#if defined(UFL_SIMD_X86)
+            case Isa::Avx2: return &fold_avx2<TIn>;
+            case Isa::Avx512: return &fold_avx512<TIn>;
+#elif defined(UFL_SIMD_NEON)
+            case Isa::Neon: return &fold_neon<TIn>;
+#endif
+            default: return &fold_scalar<float, TIn>;
+        }
+    }
+};
+
+template <>
+struct Kernels<float, int16_t> : WidenKernels<int16_t> {};
+
+template <>
+struct Kernels<float, int8_t> : WidenKernels<int8_t> {};
+
+template <>
+struct Kernels<float, float>
+{
+    static DotFn<float> dot(Isa isa)
+    {
+        switch (isa)
+        {
+#if defined(UFL_SIMD_X86)
+            case Isa::Avx2: return &dot_avx2;
+            case Isa::Avx512: return &dot_avx512;
+#elif defined(UFL_SIMD_NEON)
+            case Isa::Neon: return &dot_neon;
+#endif
+            default: return &dot_scalar<float>;
+        }
+    }
+
+    static FoldFn<float> fold(Isa isa)
+    {
+        switch (isa)
+        {
+#if defined(UFL_SIMD_X86)
+            case Isa::Avx2: return &fold_avx2<float>;
+            case Isa::Avx512: return &fold_avx512<float>;
+#elif defined(UFL_SIMD_NEON)
+            case Isa::Neon: return &fold_neon<float>;
+#endif
+            default: return &fold_scalar<float>;
+        }
+    }
+};
+
+template <>
+struct Kernels<double, double>
+{
+    static DotFn<double> dot(Isa isa)
+    {
+        switch (isa)
+        {
+#if defined(UFL_SIMD_X86)
+            case Isa::Avx2: return &dot_avx2;
+            case Isa::Avx512: return &dot_avx512;
+#elif defined(UFL_SIMD_NEON)
+            case Isa::Neon: return &dot_neon;
+#endif
+            default: return &dot_scalar<double>;
+        }
+    }
+
+    static FoldFn<double> fold(Isa isa)
+    {
+        switch (isa)
+        {
+#if defined(UFL_SIMD_X86)
+            case Isa::Avx2: return &fold_avx2;
+            case Isa::Avx512: return &fold_avx512;
+#elif defined(UFL_SIMD_NEON)
+            case Isa::Neon: return &fold_neon;
+#endif
+            default: return &fold_scalar<double>;
+        }
+    }
+};
+
+} // namespace simd
+} // namespace ufl
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ufl
+{
+
+// Pointer and length of a caller-owned buffer, as taken by the real-time entry points.
+// Converts from any contiguous container with data() and size(), e.g. std::vector, std::array
+// or, when built as C++20, std::span; it never owns or copies the elements.
+template <typename T>
+struct Span
+{
+    T* data = nullptr;
+    size_t size = 0;
+
+    Span() = default;
+    Span(T* data_, size_t size_) : data(data_), size(size_) {}
+
+    template <typename C, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<C>::type, Span>::value &&
+        std::is_convertible<decltype(std::declval<C&>().data()), T*>::value>::type>
+    Span(C&& c) : data(c.data()), size(c.size()) {}
+};
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Hot-path counters, compiled in only when UFL_ENABLE_STATS is defined;
+// otherwise UFL_STAT() expands to nothing and the stats stay empty.
+#if defined(UFL_ENABLE_STATS)
+#define UFL_STAT(...) __VA_ARGS__
+#else
+#define UFL_STAT(...)
+#endif
+
+namespace ufl
+{
+
+// Work done by one thread during a call.
+// Each thread only writes its own entry, and entries sit on separate cache lines.
+struct alignas(64) ThreadStats
+{
+    size_t outputs = 0;     // outputs computed
+    size_t skipped = 0;     // outputs left untouched because t was out of range
+    size_t interrim = 0;    // interrim samples evaluated
+    size_t macs = 0;        // tap by input multiply-accumulates
+    double seconds = 0;     // time spent on this call's work
+
+    ThreadStats& operator+=(const ThreadStats& other)
+    {
+        outputs += other.outputs;
+        skipped += other.skipped;
+        interrim += other.interrim;
+        macs += other.macs;
+        seconds += other.seconds;
+        return *this;
+    }
+};
+
+// Stats of the last call; threads[0] is the calling thread, the rest are the pool's workers
+struct CallStats
+{
+    std::vector<ThreadStats> threads;
+    double seconds = 0;     // wall time of the whole call
+
+    ThreadStats total() const
+    {
+        ThreadStats sum;
+        for (auto& thread : threads)
+            sum += thread;
+        return sum;
+    }
+
+    // Busiest thread's time over the mean; 1 is perfectly balanced
+    double imbalance() const
+    {
+        double busiest = 0, sum = 0;
+        for (auto& thread : threads)
+        {
+            busiest = thread.seconds > busiest ? thread.seconds : busiest;
+            sum += thread.seconds;
+        }
+        return sum > 0 ? busiest * threads.size() / sum : 1.0;
+    }
+};
+
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "upfirlerp.h"
+
+#include <limits>
+
+namespace ufl
+{
+
+// Stateful resampler for a continuous input stream.
+// Input arrives in consecutive blocks through push(); outputs are requested at absolute times
+// through pull(), which emits every output that the input received so far can produce.
+// Only the filter history needed by the next output is kept between blocks,
+// and the interrim samples of the last output are carried across calls,
+// so the result is bit-identical to one interpolate() call over the whole signal.
+template <typename T, typename TIn = T>
+class StreamUpfirLerp : public BaseUpfirLerp<T, StreamUpfirLerp<T, TIn>, TIn>
+{
+public:
+    // Sample period of the input stream
+    StreamUpfirLerp& set_input_period(double in_T)
+    {
+        m_in_T = in_T;
+        return *this;
+    }
+    double get_input_period() const
+    {
+        return m_in_T;
+    }
+
+    // Absolute time of the first input sample; pull() times are relative to the same clock
+    StreamUpfirLerp& set_time_origin(double t_origin)
+    {
+        m_t_origin = t_origin;
+        return *this;
+    }
+    double get_time_origin() const
+    {
+        return m_t_origin;
+    }
+
+    // Appends the next block of input.
+    // Each sample is copied into the stream buffer once. Samples that no output reads any more are
+    // dropped lazily: the buffer is only compacted once they outnumber the live ones, so the live
+    // samples moved down never outnumber the dead ones dropped, and each sample moves at most once on average.
+    void push(const std::complex<TIn>* const in, const size_t len)
+    {
+        if (m_finished)
+            throw std::logic_error("cannot push after finish()");
+
+        // The next output has j >= m_jprev, which reads no further back than this
+        if (m_jprev >= 0)
+        {
+            const index_t oldest = m_jprev / this->m_up - this->m_phase_len + 1;
+            if (oldest > static_cast<index_t>(m_live_start))
+                m_live_start = static_cast<size_t>(oldest);
+        }
+        const size_t dead = m_live_start - m_buf_start;
+        if (dead > m_buf.size() - dead)
+        {
+            m_buf.erase(m_buf.begin(), m_buf.begin() + dead);
+            m_buf_start = m_live_start;
+        }
+
+        m_buf.insert(m_buf.end(), in, in + len);
+        m_pushed += len;
+    }
+
+    void push(const std::vector<std::complex<TIn>> &in)
+    {
+        push(in.data(), in.size());
+    }
+
+    // Marks the end of the stream, so outputs up to the last input sample become computable
+    void finish()
+    {
+        m_finished = true;
+    }
+
+    // Computes outputs at the non-decreasing absolute times t[0, n), stopping at the first one
+    // that still needs input which has not been pushed yet.
+    // Returns the number of times consumed; outputs outside the signal are consumed but left untouched,
+    // as in interpolate_array().
+    size_t pull(
+        const double* const t,
+        const size_t n,
+        std::complex<T>* out
+    ){
+        this->begin_stats();
+        const int up = this->m_up;
+        // Same mapping as a single call over the whole stream, so outputs match it exactly
+        const auto map = this->time_map(m_in_T, m_pushed);
+        // Until the stream ends there is no zero padding at the end to account for
+        const size_t length = m_finished ? m_pushed : static_cast<size_t>(std::numeric_limits<index_t>::max());
+
+        size_t i = 0;
+        for (; i < n; i++)
+        {
+            if (t[i] < m_tprev)
+                throw std::invalid_argument("pull() times must be non-decreasing");
+
+            const double ti = t[i] - m_t_origin;
+            if (ti < 0 || (m_finished && ti > map.t_max))
+            {
+                UFL_STAT(this->thread_stats().skipped++;)
+                m_tprev = t[i];
+                continue;
+            }
+
+            const double jd = ti * map.scale;
+            const index_t j = static_cast<index_t>(jd);
+
+            // Interrim sample j+1 reads input up to (j+1)/up
+            if (!m_finished && static_cast<size_t>((j + 1) / up) >= m_pushed)
+                break;
+
+            this->advance_interrim_pair(j, m_jprev, m_xj1, m_xj2, m_buf.data(), length, m_buf_start);
+
+            out[i] = m_xj1 + (m_xj2 - m_xj1) * static_cast<T>(jd - static_cast<double>(j));
+            UFL_STAT(this->thread_stats().outputs++;)
+            m_tprev = t[i];
+        }
+
+        this->end_stats();
+        return i;
+    }
+
+    // Drops all input and carried state, ready for a new stream; the filter configuration is kept
+    void reset()
+    {
+        m_buf.clear();
+        m_buf_start = 0;
+        m_live_start = 0;
+        m_pushed = 0;
+        m_finished = false;
+        m_jprev = -2;
+        m_tprev = -std::numeric_limits<double>::infinity();
+    }
+
+    size_t get_pushed() const
+    {
+        return m_pushed;
+    }
+    // Samples kept for outputs still to come; the buffer holds at most about twice as many
+    size_t get_buffered() const
+    {
+        return m_pushed - m_live_start;
+    }
+    bool is_finished() const
+    {
+        return m_finished;
+    }
+
+protected:
+    double m_in_T = 1.0;
+    double m_t_origin = 0.0;
+
+    std::vector<std::complex<TIn>> m_buf; // input samples [m_buf_start, m_pushed)
+    size_t m_buf_start = 0;
+    size_t m_live_start = 0;              // oldest sample the next output may read
+    size_t m_pushed = 0;
+    bool m_finished = false;
+
+    // Carried interrim samples of the last output
+    index_t m_jprev = -2;
+    std::complex<T> m_xj1, m_xj2;
+    double m_tprev = -std::numeric_limits<double>::infinity();
+};
+
+}
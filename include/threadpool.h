@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace ufl
+{
+
+// Persistent pool of worker threads that park between jobs.
+// A job is a number of tasks, indexed [0, n), which are handed out
+// to the workers and the calling thread; run() returns when every task is done.
+// Submitting a job does not allocate, so it is safe to call from a real-time loop.
+class ThreadPool
+{
+public:
+    // Number of worker threads, not counting the thread that calls run()
+    explicit ThreadPool(int workers = 0)
+    {
+        start(workers);
+    }
+
+    ~ThreadPool()
+    {
+        stop();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Changes the number of workers; waits for any running job to finish first
+    void resize(int workers)
+    {
+        std::lock_guard<std::mutex> run_lock(m_run_mutex);
+        if (workers == static_cast<int>(m_workers.size()))
+            return;
+
+        stop();
+        start(workers);
+    }
+
+    int size() const
+    {
+        return static_cast<int>(m_workers.size());
+    }
+
+    // Which thread of its pool the caller is: 0 for whoever called run(), w + 1 for worker w
+    static int current_worker()
+    {
+        return worker_slot();
+    }
+
+    // Runs f(tidx) for every tidx in [0, n) and blocks until all have completed.
+    // The calling thread also takes tasks, so a pool with no workers runs everything inline.
+    template <typename F>
+    void run(int n, F&& f)
+    {
+        if (n <= 0)
+            return;
+
+        std::lock_guard<std::mutex> run_lock(m_run_mutex);
+
+        using Fn = typename std::remove_reference<F>::type;
+        Job job;
+        job.fn = [](void* ctx, int tidx) { (*static_cast<Fn*>(ctx))(tidx); };
+        job.ctx = const_cast<void*>(static_cast<const void*>(&f));
+        job.n = n;
+
+        // Only wake as many workers as there are tasks left after the caller's own
+        int participants = n - 1 < size() ? n - 1 : size();
+        if (participants == 0)
+        {
+            const int caller_slot = worker_slot();
+            worker_slot() = 0;
+            for (int tidx = 0; tidx < n; tidx++)
+                job.fn(job.ctx, tidx);
+            worker_slot() = caller_slot;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = job;
+            m_next.store(0, std::memory_order_relaxed);
+            m_participants = participants;
+            m_checked_in = 0;
+            m_generation++;
+        }
+        m_cv_work.notify_all();
+
+        // The caller counts as thread 0 of this pool, even if it is a worker of another one
+        const int caller_slot = worker_slot();
+        worker_slot() = 0;
+        drain(job);
+        worker_slot() = caller_slot;
+
+        // Every participant must check in before the job state is reused,
+        // so no worker can wake late and read the next job half-written
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv_done.wait(lock, [&]{ return m_checked_in == m_participants; });
+    }
+
+protected:
+    struct Job
+    {
+        void (*fn)(void*, int) = nullptr;
+        void* ctx = nullptr;
+        int n = 0;
+    };
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_run_mutex; // serialises jobs from different callers sharing this pool
+    std::mutex m_mutex;
+    std::condition_variable m_cv_work;
+    std::condition_variable m_cv_done;
+
+    Job m_job;
+    std::atomic<int> m_next{0};
+    int m_participants = 0;
+    int m_checked_in = 0;
+    uint64_t m_generation = 0;
+    bool m_stop = false;
+
+    void drain(const Job& job)
+    {
+        for (int tidx = m_next.fetch_add(1); tidx < job.n; tidx = m_next.fetch_add(1))
+            job.fn(job.ctx, tidx);
+    }
+
+    static int& worker_slot()
+    {
+        static thread_local int slot = 0;
+        return slot;
+    }
+
+    void worker_loop(int widx)
+    {
+        worker_slot() = widx + 1;
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cv_work.wait(lock, [&]{
+                return m_stop || (m_generation != seen && widx < m_participants);
+            });
+            if (m_stop)
+                return;
+
+            seen = m_generation;
+            Job job = m_job;
+            lock.unlock();
+
+            drain(job);
+
+            lock.lock();
+            if (++m_checked_in == m_participants)
+                m_cv_done.notify_one();
+        }
+    }
+
+    void start(int workers)
+    {
+        m_stop = false;
+        m_participants = 0;
+        m_workers.reserve(workers > 0 ? workers : 0);
+        for (int widx = 0; widx < workers; widx++)
+            m_workers.emplace_back(&ThreadPool::worker_loop, this, widx);
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv_work.notify_all();
+
+        for (auto& worker : m_workers)
+            worker.join();
+        m_workers.clear();
+    }
+};
+
+}
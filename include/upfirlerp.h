@@ -3,6 +3,23 @@
 #include <vector>
 #include <complex>
 #include <thread>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <chrono>
+
+#include "threadpool.h"
+#include "simd.h"
+#include "fixedpoint.h"
+#include "stats.h"
+#include "cache.h"
+#include "epilogue.h"
+#include "reorder.h"
+#include "overlapsave.h"
+#include "span.h"
 
 #ifndef NDEBUG
 #define DEBUG_PRINT(...) printf(__VA_ARGS__)
@@ -13,48 +30,147 @@
 namespace ufl
 {
 
+// Interrim sample index. 64-bit, so a capture may have more than 2^31 upsampled samples.
+using index_t = int64_t;
+
+// Ordering of the requested time vector.
+// Sorted times let consecutive outputs share interrim samples and skip the out-of-range ends by bisection.
+enum class TimeOrder
+{
+    Auto,       // check each call
+    Sorted,     // caller guarantees non-decreasing t
+    Unsorted
+};
+
+// How interrim samples are produced for a chunk of outputs.
+// PerPoint evaluates the two interrim samples around each output as it goes;
+// Block first evaluates every interrim sample in the tiles the chunk touches, then lerps from those;
+// Reorder sorts the chunk's outputs by interrim index, evaluates them in that order, so neighbours
+// share input windows and interrim samples, and scatters the results back.
+enum class Strategy
+{
+    Auto,       // chosen per thread chunk from the density of outputs over touched interrim samples
+    PerPoint,
+    Block,
+    Reorder     // only when asked for; sorted chunks stay per-point
+};
+
+// Symmetry of the filter taps h[0, N).
+// Linear-phase taps let the sub-filters that mirror themselves add mirrored input pairs before multiplying.
+enum class Symmetry
+{
+    Detect,     // found from the taps
+    None,
+    Even,       // h[k] == h[N - 1 - k], e.g. any firwin design
+    Odd         // h[k] == -h[N - 1 - k], e.g. differentiators and Hilbert transformers
+};
+
+// Outcome of a real-time entry point, which reports problems instead of throwing
+enum class Status
+{
+    Ok,
+    SizeMismatch,       // t and out differ in length
+    InvalidArgument,    // e.g. a sample period or dt that is not positive
+    Failed              // an exception was caught, e.g. a workspace had to grow and memory ran out
+};
+
+// How outputs are divided between threads
+enum class Schedule
+{
+    Dynamic,    // chunks handed out to whichever thread is free
+    Static      // one equal slice per thread
+};
 
-template <typename T, typename UflClass>
+// T is the type of the taps, the accumulation and the output;
+// TIn the type of the input samples, which may be narrower, e.g. int16_t or int8_t for raw IQ captures.
+template <typename T, typename UflClass, typename TIn = T>
 class BaseUpfirLerp
 {
 public:
 
     void interpolate_array(
-        const std::complex<T>* const in,
+        const std::complex<TIn>* const in,
         const size_t in_length,
         const double in_T,
         const double* const t,
         const size_t out_length,
         std::complex<T>* out
     ){
-        // Split the work over multiple threads
-        std::vector<std::thread> threads(m_threads);
+        detail::StoreOutput<T> store;
+        interpolate_array(in, in_length, in_T, t, out_length, out, store);
+    }
 
-        for (int tidx = 0; tidx < m_threads; tidx++)
+    // With a fused epilogue op that stores each valid output, see epilogue.h
+    template <typename Op>
+    void interpolate_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t out_length,
+        std::complex<T>* out,
+        Op& op
+    ){
+        // For sorted times, everything outside the valid range is a prefix or suffix,
+        // so it is found by bisection and only the valid span is split over the threads
+        begin_call();
+        op.grid(0, 0);
+        const TimeMap map = time_map(in_T, in_length);
+        if (m_cache.enabled() && interpolate_cached(in, in_length, map, t, out_length, out, op))
         {
-            threads.at(tidx) = std::thread(
-                &BaseUpfirLerp<T, UflClass>::interpolate_work,
-                this,
-                tidx,
-                in,
-                in_length,
-                in_T,
-                t,
-                out_length,
-                out
-            );
+            end_stats();
+            return;
         }
 
-        for (auto& thread : threads)
+        size_t istart, istop;
+        const bool sorted = valid_span(t, out_length, map, istart, istop);
+        UFL_STAT(m_stats.threads[0].skipped += out_length - (istop - istart);)
+
+        // Per-point work varies a lot between outputs (out of range, carried or not),
+        // so it is handed out in small chunks to whichever thread is free.
+        // The block engine decides per thread slice, so unsorted calls that may use it keep the static split.
+        const bool per_point = sorted || m_strategy == Strategy::PerPoint;
+        if (m_schedule == Schedule::Dynamic && per_point)
         {
-            thread.join();
+            std::fill(m_chunk_strategies.begin(), m_chunk_strategies.end(), Strategy::PerPoint);
+
+            const size_t grain = chunk_grain(istop - istart);
+            const size_t base = istart - istart % grain;
+            const size_t chunks = (istop - base + grain - 1) / grain;
+            detail::EpilogueParts<Op> parts(op, chunks, m_forks);
+            run_chunks(chunks, [&](int c){
+                const size_t cstart = std::max(istart, base + c * grain);
+                const size_t cstop = std::min(istop, base + (c + 1) * grain);
+                interpolate_points(in, in_length, map, t, cstart, cstop, sorted, out, parts[c]);
+            });
+            parts.join(op);
+            end_stats();
+            return;
         }
 
+        // Split the work over the pool's threads
+        detail::EpilogueParts<Op> parts(op, m_threads, m_forks);
+        run_threads([&](int tidx){
+            interpolate_work(
+                tidx,
+                in,
+                in_length,
+                map,
+                t,
+                istart,
+                istop,
+                sorted,
+                out,
+                parts[tidx]
+            );
+        });
+        parts.join(op);
+        end_stats();
     }
 
     // Main runtime method.
     void interpolate(
-        const std::vector<std::complex<T>> &in,
+        const std::vector<std::complex<TIn>> &in,
         const double in_T,
         const std::vector<double> &t,
         std::vector<std::complex<T>> &out
@@ -72,142 +188,1987 @@ public:
         );
     }
 
+    template <typename Op>
+    void interpolate(
+        const std::vector<std::complex<TIn>> &in,
+        const double in_T,
+        const std::vector<double> &t,
+        std::vector<std::complex<T>> &out,
+        Op& op
+    ){
+        out.resize(t.size());
+        interpolate_array(in.data(), in.size(), in_T, t.data(), t.size(), out.data(), op);
+    }
 
-    // Configures the upsampling filter taps.
+    // Times as exact fixed-point positions in input samples, see FixedTime; no sample period is needed.
+    // The interrim index and weight come from integer arithmetic alone, so resolution does not
+    // degrade with the length of the capture as it does for double times.
+    void interpolate_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const FixedTime* const t,
+        const size_t out_length,
+        std::complex<T>* out
+    ){
+        begin_call();
+        const size_t grain = chunk_grain(out_length);
+        const size_t chunks = (out_length + grain - 1) / grain;
+        run_chunks(chunks, [&](int c){
+            const size_t cstart = c * grain;
+            const size_t cstop = std::min(out_length, cstart + grain);
 
-    // array-style
-    UflClass& set_up_taps(
-        const T* const taps,
-        size_t len
+            // Sorted positions carry the pair forward; anything else just recomputes it
+            index_t jprev = -2;
+            std::complex<T> xj1, xj2;
+            UFL_STAT(size_t skipped = 0;)
+            for (size_t i = cstart; i < cstop; i++)
+            {
+                T w;
+                const index_t j = interrim_index(t[i], in_length, w);
+                if (j < 0)
+                {
+                    UFL_STAT(skipped++;)
+                    continue;
+                }
+
+                advance_interrim_pair(j, jprev, xj1, xj2, in, in_length);
+                out[i] = xj1 + (xj2 - xj1) * w;
+            }
+            UFL_STAT(thread_stats().outputs += (cstop - cstart) - skipped;)
+            UFL_STAT(thread_stats().skipped += skipped;)
+        });
+        end_stats();
+    }
+
+    void interpolate(
+        const std::vector<std::complex<TIn>> &in,
+        const std::vector<FixedTime> &t,
+        std::vector<std::complex<T>> &out
     ){
-        m_rev_taps.resize(len);
-        m_rev_taps.assign(taps, taps + len);
-        std::reverse(m_rev_taps.begin(), m_rev_taps.end());
+        out.resize(t.size());
+        interpolate_array(in.data(), in.size(), t.data(), t.size(), out.data());
+    }
 
-        return static_cast<UflClass&>(*this);
+
+    // Uniform output grid, t[k] = t0 + k * dt for k in [0, out_length).
+    // The grid is never materialised; an exact fixed-point phase accumulator steps through it,
+    // so there is no time vector to stream and no division per sample.
+    void interpolate_uniform_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t out_length,
+        std::complex<T>* out
+    ){
+        detail::StoreOutput<T> store;
+        interpolate_uniform_array(in, in_length, in_T, t0, dt, out_length, out, store);
     }
 
-    // std::vector-style
-    UflClass& set_up_taps(
-        const std::vector<T> &taps
+    // With a fused epilogue op that stores each valid output, see epilogue.h
+    template <typename Op>
+    void interpolate_uniform_array(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t out_length,
+        std::complex<T>* out,
+        Op& op
     ){
-        // Reverse them so we can perform multiplies in increasing order
-        m_rev_taps = taps;
-        std::reverse(m_rev_taps.begin(), m_rev_taps.end());
+        if (!(dt > 0))
+            throw std::invalid_argument("dt must be positive");
 
-        return static_cast<UflClass&>(*this);
+        begin_call();
+        op.grid(t0, dt);
+        const double interrim_T = in_T / static_cast<double>(m_up);
+        const double t_max = interrim_T * (in_length * m_up - 1);
+
+        // Valid outputs are the k with t0 + k * dt in [0, t_max];
+        // estimate the bounds, then settle them on the same expression
+        size_t kstart = 0;
+        if (t0 < 0)
+        {
+            double kd = std::ceil(-t0 / dt);
+            kstart = kd >= static_cast<double>(out_length) ? out_length : static_cast<size_t>(kd);
+        }
+        while (kstart < out_length && t0 + kstart * dt < 0)
+            kstart++;
+        while (kstart > 0 && t0 + (kstart - 1) * dt >= 0)
+            kstart--;
+
+        size_t kstop = kstart;
+        if (t_max >= t0)
+        {
+            double kd = std::floor((t_max - t0) / dt) + 1;
+            kstop = kd >= static_cast<double>(out_length) ? out_length : static_cast<size_t>(kd);
+        }
+        while (kstop > kstart && t0 + (kstop - 1) * dt > t_max)
+            kstop--;
+        while (kstop < out_length && t0 + kstop * dt <= t_max)
+            kstop++;
+        if (kstop < kstart)
+            kstop = kstart;
+
+        // Positions are in units of interrim samples
+        const detail::Phase64 first = detail::Phase64::from_double((t0 + kstart * dt) / interrim_T);
+        const detail::Phase64 step = detail::Phase64::from_double(dt / interrim_T);
+        UFL_STAT(m_stats.threads[0].skipped += out_length - (kstop - kstart);)
+
+        detail::EpilogueParts<Op> parts(op, m_threads, m_forks);
+        run_threads([&](int tidx){
+            Op& part = parts[tidx];
+            const size_t span = kstop - kstart;
+            const size_t tkstart = kstart + tidx * span / m_threads;
+            const size_t tkstop = kstart + (tidx + 1) * span / m_threads;
+
+            // Each thread jumps straight to its first position, exactly where stepping would have landed
+            detail::Phase64 pos = first.advanced(step, tkstart - kstart);
+
+            // Long filters on a dense enough grid read their interrim samples from overlap-save spans
+            InterrimSpan& fft_span = workspace().span;
+            const bool spans = tkstop > tkstart &&
+                fft_walk(pos.whole, first.advanced(step, tkstop - 1 - kstart).whole, tkstop - tkstart, fft_span);
+
+            // Runs of outputs go to the op while still in L1; the plain store writes them straight to out
+            const bool plain = std::is_same<Op, detail::StoreOutput<T>>::value;
+            UniformCarry carry;
+            std::complex<T> y[epilogue_tile];
+            for (size_t k0 = tkstart; k0 < tkstop; k0 += epilogue_tile)
+            {
+                const size_t n = std::min(epilogue_tile, tkstop - k0);
+                if (spans)
+                    lerp_uniform_span(pos, step, n, fft_span, in, in_length, plain ? out + k0 : y);
+                else
+                    lerp_uniform_run(pos, step, n, carry, in, in_length, plain ? out + k0 : y);
+                if (!plain)
+                    part(k0, n, nullptr, y, out + k0);
+            }
+            UFL_STAT(thread_stats().outputs += tkstop - tkstart;)
+        });
+        parts.join(op);
+        end_stats();
     }
 
-    // Configures the upsampling rate.
-    UflClass& set_up_rate(int up)
+    void interpolate_uniform(
+        const std::vector<std::complex<TIn>> &in,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t N,
+        std::vector<std::complex<T>> &out
+    ){
+        out.resize(N);
+
+        interpolate_uniform_array(
+            in.data(),
+            in.size(),
+            in_T,
+            t0,
+            dt,
+            N,
+            out.data()
+        );
+    }
+
+    template <typename Op>
+    void interpolate_uniform(
+        const std::vector<std::complex<TIn>> &in,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t N,
+        std::vector<std::complex<T>> &out,
+        Op& op
+    ){
+        out.resize(N);
+        interpolate_uniform_array(in.data(), in.size(), in_T, t0, dt, N, out.data(), op);
+    }
+
+
+    // Real-time entry points over caller-owned buffers, e.g. std::vector or std::span.
+    // They are noexcept and report problems as a Status; once reserve() has sized the workspaces
+    // for out.size outputs, they do not allocate either. An empty input leaves out untouched.
+    Status interpolate_into(
+        const Span<const std::complex<TIn>> in,
+        const double in_T,
+        const Span<const double> t,
+        const Span<std::complex<T>> out
+    ) noexcept
     {
-        m_up = up;
-        return static_cast<UflClass&>(*this);
+        detail::StoreOutput<T> store;
+        return interpolate_into(in, in_T, t, out, store);
     }
-    int get_up_rate() const
+
+    template <typename Op>
+    Status interpolate_into(
+        const Span<const std::complex<TIn>> in,
+        const double in_T,
+        const Span<const double> t,
+        const Span<std::complex<T>> out,
+        Op& op
+    ) noexcept
     {
-        return m_up;
+        if (t.size != out.size)
+            return Status::SizeMismatch;
+        if (!(in_T > 0))
+            return Status::InvalidArgument;
+        if (in.size == 0)
+            return Status::Ok;
+
+        try
+        {
+            interpolate_array(in.data, in.size, in_T, t.data, t.size, out.data, op);
+        }
+        catch (...)
+        {
+            return Status::Failed;
+        }
+        return Status::Ok;
     }
 
-    // Configure number of threads to use
-    UflClass& set_threads(int threads)
+    Status interpolate_into(
+        const Span<const std::complex<TIn>> in,
+        const Span<const FixedTime> t,
+        const Span<std::complex<T>> out
+    ) noexcept
     {
-        m_threads = threads;
-        return static_cast<UflClass&>(*this);
+        if (t.size != out.size)
+            return Status::SizeMismatch;
+        if (in.size == 0)
+            return Status::Ok;
+
+        try
+        {
+            interpolate_array(in.data, in.size, t.data, t.size, out.data);
+        }
+        catch (...)
+        {
+            return Status::Failed;
+        }
+        return Status::Ok;
     }
-    int get_threads() const
+
+    // Uniform grid t0 + k * dt over every k of out
+    Status interpolate_uniform_into(
+        const Span<const std::complex<TIn>> in,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const Span<std::complex<T>> out
+    ) noexcept
     {
-        return m_threads;
+        detail::StoreOutput<T> store;
+        return interpolate_uniform_into(in, in_T, t0, dt, out, store);
+    }
+
+    template <typename Op>
+    Status interpolate_uniform_into(
+        const Span<const std::complex<TIn>> in,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const Span<std::complex<T>> out,
+        Op& op
+    ) noexcept
+    {
+        if (!(in_T > 0) || !(dt > 0))
+            return Status::InvalidArgument;
+        if (in.size == 0)
+            return Status::Ok;
+
+        try
+        {
+            interpolate_uniform_array(in.data, in.size, in_T, t0, dt, out.size, out.data, op);
+        }
+        catch (...)
+        {
+            return Status::Failed;
+        }
+        return Status::Ok;
     }
 
 
-protected:
-    int m_threads = 1;
-    int m_up = 1;
+    // Multi-channel, channel-major: in[c] holds in_length samples of channel c, out[c] receives out_length outputs.
+    // All channels share t and the taps; j and the lerp weight are computed once per output
+    // for a tile of outputs and then reused for every channel, and threads split both outputs and channels.
+    void interpolate_channels(
+        const std::complex<TIn>* const* in,
+        const size_t channels,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t out_length,
+        std::complex<T>* const* out
+    ){
+        begin_call();
+        const TimeMap map = time_map(in_T, in_length);
+        size_t istart, istop;
+        valid_span(t, out_length, map, istart, istop);
+        UFL_STAT(m_stats.threads[0].skipped += (out_length - (istop - istart)) * channels;)
 
-    std::vector<T> m_rev_taps;
+        const int ch_parts = channel_parts(channels);
+        const int out_parts = m_threads / ch_parts;
 
+        run_threads([&](int tidx){
+            const size_t cstart = (tidx % ch_parts) * channels / ch_parts;
+            const size_t cstop = (tidx % ch_parts + 1) * channels / ch_parts;
+            const size_t span = istop - istart;
+            const size_t tistart = istart + (tidx / ch_parts) * span / out_parts;
+            const size_t tistop = istart + (tidx / ch_parts + 1) * span / out_parts;
 
-    void interpolate_work(
-        int tidx,
-        const std::complex<T>* const in,
+            constexpr size_t tile = 256;
+            index_t js[tile];
+            T ws[tile];
+
+            for (size_t i0 = tistart; i0 < tistop; i0 += tile)
+            {
+                const size_t n = tistop - i0 < tile ? tistop - i0 : tile;
+                UFL_STAT(size_t valid = 0;)
+                for (size_t k = 0; k < n; k++)
+                {
+                    js[k] = interrim_index(t[i0 + k], map, ws[k]);
+                    UFL_STAT(valid += js[k] >= 0;)
+                }
+                UFL_STAT(thread_stats().outputs += valid * (cstop - cstart);)
+                UFL_STAT(thread_stats().skipped += (n - valid) * (cstop - cstart);)
+
+                // Each channel's input window stays hot in cache across the tile
+                for (size_t c = cstart; c < cstop; c++)
+                {
+                    index_t jprev = -2;
+                    std::complex<T> xj1, xj2;
+                    for (size_t k = 0; k < n; k++)
+                    {
+                        if (js[k] < 0)
+                            continue;
+
+                        advance_interrim_pair(js[k], jprev, xj1, xj2, in[c], in_length);
+                        out[c][i0 + k] = xj1 + (xj2 - xj1) * ws[k];
+                    }
+                }
+            }
+        });
+        end_stats();
+    }
+
+    // Multi-channel, sample-interleaved: in[k * channels + c] and out[i * channels + c].
+    // Each interrim sample is one pass over the window's rows that accumulates every channel at once.
+    void interpolate_interleaved(
+        const std::complex<TIn>* const in,
+        const size_t channels,
         const size_t in_length,
         const double in_T,
         const double* const t,
         const size_t out_length,
         std::complex<T>* out
     ){
-        DEBUG_PRINT("Thread %d: output is size %zd\n", tidx, out_length);
+        begin_call();
+        const TimeMap map = time_map(in_T, in_length);
+        size_t istart, istop;
+        valid_span(t, out_length, map, istart, istop);
+        UFL_STAT(m_stats.threads[0].skipped += (out_length - (istop - istart)) * channels;)
 
-        // Precompute the upsampled period
-        const double interrim_T = in_T / static_cast<double>(m_up);
+        const int ch_parts = channel_parts(channels);
+        const int out_parts = m_threads / ch_parts;
 
-        // Define thread workspace
-        int tistart = tidx * out_length / m_threads;
-        int tistop = (tidx + 1) * out_length / m_threads;
-        tistop = tistop > out_length ? out_length : tistop; // ensure last thread doesn't go out of bounds
+        run_threads([&](int tidx){
+            const size_t cstart = (tidx % ch_parts) * channels / ch_parts;
+            const size_t width = (tidx % ch_parts + 1) * channels / ch_parts - cstart;
+            const size_t span = istop - istart;
+            const size_t tistart = istart + (tidx / ch_parts) * span / out_parts;
+            const size_t tistop = istart + (tidx / ch_parts + 1) * span / out_parts;
 
-        for(int i=tistart; i<tistop; i++)
-        {
-            // We exclude interpolation for any sample that is outside the upsampled range
-            if (t[i] < 0 || t[i] > interrim_T * (in_length * m_up - 1))
+            std::vector<std::complex<T>>& scratch = workspace().channels;
+            scratch.resize(2 * width);
+            std::complex<T>* xj1 = scratch.data();
+            std::complex<T>* xj2 = scratch.data() + width;
+            index_t jprev = -2;
+
+            for (size_t i = tistart; i < tistop; i++)
             {
-                DEBUG_PRINT("t[%d] = %f is outside the valid upsampled range [0, %f]\n",
-                       i, t[i], interrim_T * (in_length * m_up - 1));
+                T w;
+                const index_t j = interrim_index(t[i], map, w);
+                if (j < 0)
+                {
+                    UFL_STAT(thread_stats().skipped += width;)
+                    continue;
+                }
+                UFL_STAT(thread_stats().outputs += width;)
 
-                continue;
+                if (j == jprev + 1)
+                {
+                    std::swap(xj1, xj2);
+                    calculate_interrim_interleaved(j + 1, in + cstart, channels, width, in_length, xj2);
+                }
+                else if (j != jprev)
+                {
+                    calculate_interrim_interleaved(j, in + cstart, channels, width, in_length, xj1);
+                    calculate_interrim_interleaved(j + 1, in + cstart, channels, width, in_length, xj2);
+                }
+                jprev = j;
+
+                std::complex<T>* row = out + i * channels + cstart;
+                for (size_t c = 0; c < width; c++)
+                    row[c] = xj1[c] + (xj2[c] - xj1[c]) * w;
             }
-            // Compute the interrim sample number
-            double jd = t[i] / interrim_T;
-            int j = static_cast<int>(jd);
+        });
+        end_stats();
+    }
 
-            DEBUG_PRINT("t[%d]=%f -> %f[%d]\n", i, t[i], jd, j);
 
-            // Linearly interpolate between this and the next sample
-            std::complex<T> xj1 = calculate_interrim_sample(j, in, in_length);
-            std::complex<T> xj2 = calculate_interrim_sample(j+1, in, in_length);
-            // Compute the time values at just the 1st sample
-            double tj1 = interrim_T * j;
+    // Multi-hypothesis, e.g. for delay searches: out[k * out_length + i] is the output at t[i] + offsets[k].
+    // Each chunk of outputs evaluates every distinct interrim sample its hypotheses need once
+    // and shares it between them, so K hypotheses cost about one filter pass plus K lerps.
+    void interpolate_offsets(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t out_length,
+        const double* const offsets,
+        const size_t hypotheses,
+        std::complex<T>* out
+    ){
+        interpolate_hypotheses(in, in_length, in_T, out_length, hypotheses,
+            [t, offsets](size_t k, size_t i){ return t[i] + offsets[k]; }, out);
+    }
 
-            // Then interpolate
-            // TODO: determine if downcasting to float is ok?
-            out[i] = xj1 + (xj2 - xj1) * static_cast<T>((t[i] - tj1) / interrim_T);
-        }
+    void interpolate_offsets(
+        const std::vector<std::complex<TIn>> &in,
+        const double in_T,
+        const std::vector<double> &t,
+        const std::vector<double> &offsets,
+        std::vector<std::complex<T>> &out
+    ){
+        out.resize(offsets.size() * t.size());
+        interpolate_offsets(in.data(), in.size(), in_T, t.data(), t.size(), offsets.data(), offsets.size(), out.data());
     }
 
-    // Helper method
-    std::complex<T> calculate_interrim_sample(
-        const int j,
-        const std::complex<T>* const in,
-        const size_t in_length
+    // Multi-hypothesis with a time matrix: row k of t, t[k * out_length, (k + 1) * out_length), is hypothesis k,
+    // and out has the same layout. Interrim samples are shared as in interpolate_offsets().
+    void interpolate_matrix(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const double* const t,
+        const size_t hypotheses,
+        const size_t out_length,
+        std::complex<T>* out
     ){
-        // We need to perform the dot product from [j-m_rev_taps.size()+1 , j]
-        int start = j - m_rev_taps.size() + 1; // keep this so we can reference the taps vector index
-        // Enforce starting at 0
-        int zstart = start < 0 ? 0 : start;
-        // Now enforce starting at a non-zero index (0, 1*m_up, 2*m_up,...)
-        if (zstart % m_up != 0 && j - zstart >= m_up)
-            zstart += m_up - (zstart % m_up);
+        interpolate_hypotheses(in, in_length, in_T, out_length, hypotheses,
+            [t, out_length](size_t k, size_t i){ return t[k * out_length + i]; }, out);
+    }
 
-        // Enforce ending to be size of the upsampled input
-        int zend = j >= in_length * m_up ? in_length * m_up - 1 : j;
 
-        if (zstart <= j)
-            DEBUG_PRINT("==Interrim %d: dot prod from %d(%d) to %zd(%d)\n", j, start, zstart, start + m_rev_taps.size() - 1, zend);
-        else
-            DEBUG_PRINT("==Interrim %d: no valid dot prod\n", j);
+    // Configures the upsampling filter taps.
+    // A declared symmetry is imposed by mirroring the first half of the taps onto the second;
+    // a detected one must hold to within a few rounding errors.
 
-        // Finally iterate forwards with the dot product
-        std::complex<T> xj = {0, 0};
+    // array-style
+    UflClass& set_up_taps(
+        const T* const taps,
+        size_t len,
+        Symmetry symmetry = Symmetry::Detect
+    ){
+        m_taps.assign(taps, taps + len);
+        apply_symmetry(symmetry);
+        prepare_bank();
 
-        for (int i = zstart; i <= zend; i += m_up)
-        {
-            DEBUG_PRINT("==Accessing interrim index %d -> index %d from input\n", i, i/m_up);
-            DEBUG_PRINT("==Multiplying by taps[%d]\n", i - start);
-            xj += in[i / m_up] * static_cast<T>(m_rev_taps.at(i - start));
+        return static_cast<UflClass&>(*this);
+    }
+
+    // std::vector-style
+    UflClass& set_up_taps(
+        const std::vector<T> &taps,
+        Symmetry symmetry = Symmetry::Detect
+    ){
+        m_taps = taps;
+        apply_symmetry(symmetry);
+        prepare_bank();
+
+        return static_cast<UflClass&>(*this);
+    }
+
+    // Taking over the caller's vector, without copying it
+    UflClass& set_up_taps(
+        std::vector<T> &&taps,
+        Symmetry symmetry = Symmetry::Detect
+    ){
+        m_taps = std::move(taps);
+        apply_symmetry(symmetry);
+        prepare_bank();
+
+        return static_cast<UflClass&>(*this);
+    }
+
+    // Symmetry of the current taps, None, Even or Odd
+    Symmetry get_tap_symmetry() const
+    {
+        return m_symmetry;
+    }
+
+    // Configures the upsampling rate.
+    UflClass& set_up_rate(int up)
+    {
+        if (up < 1)
+            throw std::invalid_argument("up rate must be at least 1");
+
+        m_up = up;
+        prepare_bank();
+        return static_cast<UflClass&>(*this);
+    }
+    int get_up_rate() const
+    {
+        return m_up;
+    }
+
+    // Multiplies every input sample by scale, e.g. 1/32768 for full-scale 16-bit IQ.
+    // It is folded into the polyphase bank, so it costs nothing per sample.
+    UflClass& set_input_scale(T scale)
+    {
+        m_in_scale = scale;
+        prepare_bank();
+        return static_cast<UflClass&>(*this);
+    }
+    T get_input_scale() const
+    {
+        return m_in_scale;
+    }
+
+    // Configure number of threads to use.
+    // Workers are kept alive in a pool and park between calls;
+    // the calling thread always does one share of the work itself.
+    UflClass& set_threads(int threads)
+    {
+        m_threads = threads < 1 ? 1 : threads;
+        m_chunk_strategies.assign(m_threads, Strategy::PerPoint);
+        if (m_threads > 1 && !m_pool)
+            m_pool = std::make_shared<ThreadPool>();
+        if (m_pool)
+            m_pool->resize(m_threads - 1);
+        size_workspaces();
+        return static_cast<UflClass&>(*this);
+    }
+    int get_threads() const
+    {
+        return m_threads;
+    }
+
+    // Sizes every thread's workspace up front for calls of up to out_length outputs, so that
+    // interpolate_array(), interpolate_uniform_array() and the *_into() entry points do not allocate from
+    // the first call on, whatever the strategy; only forced Block on sparse times may still grow a tile buffer.
+    // Otherwise workspaces grow on demand and are kept, so only calls larger than any before allocate.
+    // Not covered: the interrim cache, stats builds, and a stateful epilogue op on several threads,
+    // whose forks are kept after the first such call. Later changes of threads, filter or strategy resize them.
+    UflClass& reserve(size_t out_length)
+    {
+        m_reserved = out_length;
+        size_workspaces();
+        return static_cast<UflClass&>(*this);
+    }
+    size_t get_reserved() const
+    {
+        return m_reserved;
+    }
+
+    // Share an existing pool, e.g. between several interpolators.
+    // The thread count is taken from the pool's size; set_threads() afterwards resizes the shared pool.
+    UflClass& set_thread_pool(std::shared_ptr<ThreadPool> pool)
+    {
+        m_pool = std::move(pool);
+        m_threads = m_pool ? m_pool->size() + 1 : 1;
+        m_chunk_strategies.assign(m_threads, Strategy::PerPoint);
+        size_workspaces();
+        return static_cast<UflClass&>(*this);
+    }
+    std::shared_ptr<ThreadPool> get_thread_pool() const
+    {
+        return m_pool;
+    }
+
+    // Selects how outputs are split over the threads.
+    // Dynamic hands out chunks of grain outputs (0 picks about 8 chunks per thread) as threads become free,
+    // which keeps them busy when t is clustered or partly out of range; Static gives each thread an equal slice.
+    UflClass& set_schedule(Schedule schedule, size_t grain = 0)
+    {
+        m_schedule = schedule;
+        m_grain = grain;
+        return static_cast<UflClass&>(*this);
+    }
+    Schedule get_schedule() const
+    {
+        return m_schedule;
+    }
+    size_t get_grain() const
+    {
+        return m_grain;
+    }
+
+    // Selects per-point or block evaluation; Auto decides per thread chunk.
+    // An unsorted chunk goes to the block engine when outputs / touched interrim samples >= block_density
+    // and the dot products saved outweigh gathering from the tiles, i.e. for long filters or cache-sized tiles.
+    // Sorted chunks already evaluate each interrim sample at most once, so Auto keeps those per-point.
+    // Reorder suits large unsorted chunks spread over an input too large for the cache, where every
+    // per-point output would fetch its input window from memory; it costs a sort and two scattered passes.
+    UflClass& set_strategy(Strategy strategy, double block_density = 0.5)
+    {
+        m_strategy = strategy;
+        m_block_density = block_density;
+        size_workspaces();
+        return static_cast<UflClass&>(*this);
+    }
+    Strategy get_strategy() const
+    {
+        return m_strategy;
+    }
+    double get_block_density() const
+    {
+        return m_block_density;
+    }
+    // What each thread chunk of the last call actually used
+    const std::vector<Strategy>& get_last_strategies() const
+    {
+        return m_chunk_strategies;
+    }
+
+    // Counters and timings of the last call, per thread; empty unless built with UFL_ENABLE_STATS
+    const CallStats& get_last_stats() const
+    {
+        return m_stats;
+    }
+#if defined(UFL_ENABLE_STATS)
+    static constexpr bool stats_enabled = true;
+#else
+    static constexpr bool stats_enabled = false;
+#endif
+
+    // Keeps up to tiles tiles of 256 interrim samples between interpolate_array() calls on the same input,
+    // so repeated calls at nearby times only compute the interrim samples no earlier call needed; 0 turns it off.
+    // A call needing more tiles than that runs uncached. Passing another buffer or length, or changing
+    // the filter, drops the cached tiles; after changing the input in place, call invalidate_interrim_cache().
+    UflClass& set_interrim_cache(size_t tiles)
+    {
+        m_cache.set_capacity(tiles);
+        return static_cast<UflClass&>(*this);
+    }
+    size_t get_interrim_cache() const
+    {
+        return m_cache.capacity();
+    }
+    UflClass& invalidate_interrim_cache()
+    {
+        m_cache.invalidate();
+        return static_cast<UflClass&>(*this);
+    }
+    // Interrim sample hits and misses, and tile evictions, since the cache was last configured
+    const CacheStats& get_cache_stats() const
+    {
+        return m_cache.stats();
+    }
+
+    // Sub-filter length (taps / up rate) from which dense runs of interrim samples are computed by overlap-save
+    // FFT convolution instead of a dot product each, see overlapsave.h; 0 turns the FFT engine off.
+    // Past it, the FFT's work per interrim sample grows only with the log of the filter length.
+    // Runs too short, or outputs too sparse, to pay for a whole transform block still use dot products.
+    UflClass& set_fft_crossover(int phase_taps)
+    {
+        m_fft_crossover = phase_taps < 0 ? 0 : phase_taps;
+        configure_fft();
+        return static_cast<UflClass&>(*this);
+    }
+    int get_fft_crossover() const
+    {
+        return m_fft_crossover;
+    }
+    // Whether the current filter is long enough for the FFT engine
+    bool uses_fft() const
+    {
+        return m_fft.ready();
+    }
+    // From the "fft crossover" benchmark: the shortest sub-filter on which overlap-save won at both densities
+    static constexpr int default_fft_crossover = 64;
+
+    // Declares the ordering of t; by default it is checked every call
+    UflClass& set_time_order(TimeOrder order)
+    {
+        m_time_order = order;
+        return static_cast<UflClass&>(*this);
+    }
+    TimeOrder get_time_order() const
+    {
+        return m_time_order;
+    }
+
+    // Selects the dot product kernel; defaults to the best one this CPU supports.
+    // Mostly useful to pin the scalar path for comparisons.
+    // Sub-filters shorter than min_vector_taps take the scalar kernels whatever the choice.
+    UflClass& set_isa(simd::Isa isa)
+    {
+        if (!simd::isa_supported(isa))
+            throw std::invalid_argument(std::string("instruction set not supported: ") + simd::isa_name(isa));
+
+        m_isa = isa;
+        select_kernels();
+        m_cache.invalidate();
+        return static_cast<UflClass&>(*this);
+    }
+    simd::Isa get_isa() const
+    {
+        return m_isa;
+    }
+
+
+protected:
+    struct Workspace;
+
+    int m_threads = 1;
+    int m_up = 1;
+    TimeOrder m_time_order = TimeOrder::Auto;
+
+    Schedule m_schedule = Schedule::Dynamic;
+    size_t m_grain = 0;
+    // Automatic grain: about this many chunks per thread, but never smaller than min_auto_grain outputs
+    static constexpr size_t chunks_per_thread = 8;
+    static constexpr size_t min_auto_grain = 1024;
+
+    Strategy m_strategy = Strategy::Auto;
+    double m_block_density = 0.5;
+    std::vector<Strategy> m_chunk_strategies = std::vector<Strategy>(1, Strategy::PerPoint);
+    // Outputs the reordered walk looks ahead to prefetch their slots
+    static constexpr size_t reorder_prefetch = 16;
+
+    // Interrim samples per tile of the block engine
+    static constexpr int block_tile = 256;
+    // Tile buffer size that still gathers at cache speed
+    static constexpr size_t block_cache_bytes = size_t(1) << 20;
+
+    // Times to interrim samples, with the reciprocal and the range limit hoisted out of the loops
+    struct TimeMap
+    {
+        double scale;   // interrim samples per unit of time
+        double t_max;   // time of the last upsampled sample
+    };
+
+    TimeMap time_map(const double in_T, const size_t in_length) const
+    {
+        const double interrim_T = in_T / static_cast<double>(m_up);
+        return TimeMap{1.0 / interrim_T, interrim_T * (in_length * m_up - 1)};
+    }
+
+    // Tiles of interrim samples touched by one thread chunk
+    struct BlockPlan
+    {
+        std::vector<index_t> js;    // interrim index per output, -1 when out of range
+        std::vector<T> ws;          // lerp weight per output
+        std::vector<int> slots;     // buffer slot per tile from jbase, -1 when untouched
+        index_t jbase = 0;
+        size_t valid = 0;
+        size_t touched = 0;
+    };
+
+    std::shared_ptr<ThreadPool> m_pool;
+
+    simd::Isa m_isa = simd::detect_isa();
+    simd::DotFn<T, TIn> m_dot = simd::Kernels<T, TIn>::dot(m_isa);
+    simd::FoldFn<T, TIn> m_fold = simd::Kernels<T, TIn>::fold(m_isa);
+
+    // A vector kernel's fixed cost, the store and reduction over all of its lanes, outweighs what it saves
+    // on a few taps; below this many per sub-filter the scalar loop is as fast or faster
+    static constexpr int min_vector_taps = 8;
+
+    // The kernels of m_isa, or the scalar ones for sub-filters too short to gain from them
+    void select_kernels()
+    {
+        const simd::Isa isa = m_phase_len < min_vector_taps ? simd::Isa::Scalar : m_isa;
+        m_dot = simd::Kernels<T, TIn>::dot(isa);
+        m_fold = simd::Kernels<T, TIn>::fold(isa);
+    }
+
+    // The derived class may replace calculate_interrim_sample() and bank_changed(),
+    // e.g. with specialisations for a fixed filter shape
+    UflClass& derived()
+    {
+        return static_cast<UflClass&>(*this);
+    }
+
+    // Called after every rebuild of the polyphase bank
+    void bank_changed() {}
+
+    // Runs f(tidx) for tidx in [0, m_threads) on the pool, or inline when single-threaded
+    template <typename F>
+    void run_threads(F&& f)
+    {
+        if (m_threads > 1 && m_pool)
+            m_pool->run(m_threads, [&](int tidx){ run_task(f, tidx, true); });
+        else
+            for (int tidx = 0; tidx < m_threads; tidx++)
+                run_task(f, tidx, false);
+    }
+
+    // Runs f(c) for c in [0, chunks); the pool hands each chunk to the next free thread
+    template <typename F>
+    void run_chunks(size_t chunks, F&& f)
+    {
+        if (m_threads > 1 && m_pool)
+            m_pool->run(static_cast<int>(chunks), [&](int c){ run_task(f, c, true); });
+        else
+            for (size_t c = 0; c < chunks; c++)
+                run_task(f, static_cast<int>(c), false);
+    }
+
+    CallStats m_stats;
+    UFL_STAT(std::chrono::steady_clock::time_point m_call_start;)
+
+    // Stats entry of the thread running the current task
+    static ThreadStats*& current_stats()
+    {
+        static thread_local ThreadStats* current = nullptr;
+        return current;
+    }
+    ThreadStats& thread_stats()
+    {
+        ThreadStats* current = current_stats();
+        return current ? *current : m_stats.threads[0];
+    }
+
+    // Runs f(i), pointing the thread's counters at its own entry and timing it when stats are on
+    template <typename F>
+    void run_task(F& f, int i, bool pooled)
+    {
+#if defined(UFL_ENABLE_STATS)
+        ThreadStats* const previous = current_stats();
+        ThreadStats* const current = &m_stats.threads[pooled ? ThreadPool::current_worker() : 0];
+        current_stats() = current;
+        const auto start = std::chrono::steady_clock::now();
+        f(i);
+        current->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        current_stats() = previous;
+#else
+        (void)pooled;
+        f(i);
+#endif
+    }
+
+    // Start of every call: workspaces for any thread the pool has gained since, then the stats
+    void begin_call()
+    {
+        claim_workspaces();
+        begin_stats();
+    }
+
+    // One entry per thread that may take part, the caller first
+    void begin_stats()
+    {
+        UFL_STAT(
+            m_stats.threads.assign(m_pool ? m_pool->size() + 1 : 1, ThreadStats());
+            m_call_start = std::chrono::steady_clock::now();
+        )
+    }
+    void end_stats()
+    {
+        UFL_STAT(m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_call_start).count();)
+    }
+
+    // Outputs per dynamic chunk, a multiple of 16 so that neighbouring chunks
+    // never write to the same cache line of the output
+    size_t chunk_grain(const size_t span) const
+    {
+        if (m_threads == 1)
+            return span > 0 ? span : 1;
+
+        size_t grain = m_grain;
+        if (grain == 0)
+        {
+            grain = span / (static_cast<size_t>(m_threads) * chunks_per_thread);
+            grain = grain < min_auto_grain ? min_auto_grain : grain;
+        }
+        return (grain + 15) / 16 * 16;
+    }
+
+    std::vector<T> m_taps;
+    T m_in_scale = 1;
+    Symmetry m_symmetry = Symmetry::None;
+
+    // Polyphase bank, m_up sub-filters of m_phase_len taps each, stored contiguously.
+    // Sub-filter p holds taps[p], taps[p + m_up], taps[p + 2*m_up], ...
+    // reversed, scaled by the input scale and zero-padded at the front, so that an interrim sample
+    // is a forward dot product over contiguous input samples.
+    std::vector<T> m_bank;
+    int m_phase_len = 0;
+
+    // Sub-filter p is its own mirror when taps p and N - 1 - p fall in it, i.e. when 2p == N - 1 modulo m_up:
+    // every phase without upsampling, or for odd N at an upsample rate of 2, otherwise one or two phases.
+    // Its nonzero taps are then the last ones of the sub-filter, from m_fold_start[p] on, and read the same
+    // backwards up to m_fold_sign. -1 for the other phases, and for windows too short to gain from folding.
+    std::vector<int> m_fold_start{-1};
+    T m_fold_sign = 1;
+    static constexpr int min_fold_taps = 32;
+
+    // Overlap-save engine, set up while the sub-filters are at least m_fft_crossover taps long
+    OverlapSave<T> m_fft;
+    int m_fft_crossover = default_fft_crossover;
+
+    void configure_fft()
+    {
+        if (m_fft_crossover > 0 && m_phase_len >= m_fft_crossover)
+            m_fft.configure(m_bank.data(), m_up, m_phase_len);
+        else
+            m_fft.clear();
+        size_workspaces();
+    }
+
+    // Settles m_symmetry for the new taps
+    void apply_symmetry(Symmetry symmetry)
+    {
+        if (symmetry == Symmetry::Detect)
+            symmetry = mirrors(T(1)) ? Symmetry::Even : mirrors(T(-1)) ? Symmetry::Odd : Symmetry::None;
+
+        // Make the mirror exact, so the folded and unfolded sub-filters agree
+        const size_t n = m_taps.size();
+        if (symmetry != Symmetry::None)
+        {
+            const T sign = symmetry == Symmetry::Even ? T(1) : T(-1);
+            for (size_t k = 0; k < n / 2; k++)
+                m_taps[n - 1 - k] = sign * m_taps[k];
+            if (symmetry == Symmetry::Odd && n % 2)
+                m_taps[n / 2] = 0;
+        }
+        m_symmetry = symmetry;
+    }
+
+    // Whether m_taps[k] == sign * m_taps[N - 1 - k], allowing for taps designed in a wider type and rounded
+    bool mirrors(const T sign) const
+    {
+        const size_t n = m_taps.size();
+        T peak = 0;
+        for (const T& tap : m_taps)
+            peak = std::max(peak, std::abs(tap));
+        const T tolerance = 4 * std::numeric_limits<T>::epsilon() * peak;
+
+        for (size_t k = 0; k < (n + 1) / 2; k++)
+            if (std::abs(m_taps[k] - sign * m_taps[n - 1 - k]) > tolerance)
+                return false;
+        return true;
+    }
+
+    // Rebuilds the polyphase bank; called whenever the taps or upsample rate change
+    void prepare_bank()
+    {
+        m_phase_len = static_cast<int>((m_taps.size() + m_up - 1) / m_up);
+        m_bank.assign(static_cast<size_t>(m_up) * m_phase_len, 0);
+        select_kernels();
+
+        for (int p = 0; p < m_up; p++)
+        {
+            for (int q = 0; q < m_phase_len; q++)
+            {
+                size_t k = p + static_cast<size_t>(q) * m_up;
+                if (k < m_taps.size())
+                    m_bank[p * m_phase_len + m_phase_len - 1 - q] = m_taps[k] * m_in_scale;
+            }
+        }
+
+        m_fold_start.assign(m_up, -1);
+        m_fold_sign = m_symmetry == Symmetry::Odd ? T(-1) : T(1);
+        for (int p = 0; p < m_up && m_symmetry != Symmetry::None; p++)
+        {
+            const long long mirror = static_cast<long long>(m_taps.size()) - 1 - 2 * p;
+            if (mirror < 0 || mirror % m_up != 0)
+                continue;
+
+            const int len = static_cast<int>(mirror / m_up) + 1;
+            if (len >= min_fold_taps)
+                m_fold_start[p] = m_phase_len - len;
+        }
+
+        configure_fft();
+        m_cache.invalidate();
+        derived().bank_changed();
+    }
+
+
+    template <typename Op>
+    void interpolate_work(
+        int tidx,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const TimeMap& map,
+        const double* const t,
+        const size_t istart,
+        const size_t istop,
+        const bool sorted,
+        std::complex<T>* out,
+        Op& op
+    ){
+        DEBUG_PRINT("Thread %d: output span is [%zd, %zd)\n", tidx, istart, istop);
+
+        // Define thread workspace
+        const size_t span = istop - istart;
+        const size_t tistart = istart + tidx * span / m_threads;
+        const size_t tistop = istart + (tidx + 1) * span / m_threads;
+
+        Workspace& work = workspace();
+        if (m_strategy == Strategy::Reorder && !sorted)
+        {
+            m_chunk_strategies[tidx] = Strategy::Reorder;
+            interpolate_reordered(work.reorder, in, in_length, map, t, tistart, tistop, out, op);
+            return;
+        }
+
+        // Dense unsorted chunks are cheaper to evaluate as whole tiles of interrim samples
+        Strategy strategy = m_strategy;
+        BlockPlan& plan = work.plan;
+        if (strategy == Strategy::Block || (strategy == Strategy::Auto && !sorted))
+            strategy = plan_blocks(t, tistart, tistop, map, strategy == Strategy::Block, plan);
+        else
+            strategy = Strategy::PerPoint;
+        m_chunk_strategies[tidx] = strategy;
+
+        if (strategy == Strategy::Block)
+        {
+            interpolate_blocks(plan, work, in, in_length, t, tistart, tistop, out, op);
+            return;
+        }
+
+        interpolate_points(in, in_length, map, t, tistart, tistop, sorted, out, op);
+    }
+
+    // Per-point evaluation of the outputs [tistart, tistop)
+    template <typename Op>
+    void interpolate_points(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const TimeMap& map,
+        const double* const t,
+        const size_t tistart,
+        const size_t tistop,
+        const bool sorted,
+        std::complex<T>* out,
+        Op& op
+    ){
+        detail::EpilogueStage<T, Op> stage(op, t, out);
+        if (sorted)
+        {
+            // The span is already trimmed to the valid range, and j never decreases,
+            // so the last pair of interrim samples is carried forward and only recomputed when j moves
+            index_t jprev = -2;
+            std::complex<T> xj1, xj2;
+
+            // Long filters over a dense enough stretch read them from overlap-save spans instead
+            InterrimSpan& fft_span = workspace().span;
+            const bool spans = tistop > tistart && fft_walk(
+                static_cast<index_t>(t[tistart] * map.scale), static_cast<index_t>(t[tistop - 1] * map.scale),
+                tistop - tistart, fft_span);
+
+            for (size_t i = tistart; i < tistop; i++)
+            {
+                const double jd = t[i] * map.scale;
+                const index_t j = static_cast<index_t>(jd);
+
+                DEBUG_PRINT("t[%zd]=%f -> %f[%lld]\n", i, t[i], jd, static_cast<long long>(j));
+
+                if (spans)
+                    span_interrim_pair(j, fft_span, xj1, xj2, in, in_length);
+                else
+                    advance_interrim_pair(j, jprev, xj1, xj2, in, in_length);
+
+                stage.push(i, xj1 + (xj2 - xj1) * static_cast<T>(jd - static_cast<double>(j)));
+            }
+            UFL_STAT(thread_stats().outputs += tistop - tistart;)
+            return;
+        }
+
+        UFL_STAT(size_t skipped = 0;)
+        for (size_t i = tistart; i < tistop; i++)
+        {
+            // We exclude interpolation for any sample that is outside the upsampled range
+            T w;
+            const index_t j = interrim_index(t[i], map, w);
+            if (j < 0)
+            {
+                DEBUG_PRINT("t[%zd] = %f is outside the valid upsampled range [0, %f]\n", i, t[i], map.t_max);
+
+                UFL_STAT(skipped++;)
+                continue;
+            }
+
+            // Linearly interpolate between this and the next sample
+            std::complex<T> xj1 = derived().calculate_interrim_sample(j, in, in_length);
+            std::complex<T> xj2 = derived().calculate_interrim_sample(j+1, in, in_length);
+
+            // TODO: determine if downcasting to float is ok?
+            stage.push(i, xj1 + (xj2 - xj1) * w);
+        }
+        UFL_STAT(thread_stats().outputs += (tistop - tistart) - skipped;)
+        UFL_STAT(thread_stats().skipped += skipped;)
+    }
+
+    // Reordered evaluation of the unsorted outputs [tistart, tistop).
+    // Each valid output is keyed by its interrim index above its offset in the chunk, and a stable radix sort
+    // on the index bits alone orders them by index, ties in output order. Walking that order carries the
+    // interrim pair like a sorted call and sweeps the input once. The lerp weight waits in the output's own slot,
+    // which the walk writes anyway, so the keys stay 8 bytes and the walk never reads t.
+    // If index and offset do not fit in 64 bits together, the low index bits are dropped, which only coarsens the order.
+    template <typename Op>
+    void interpolate_reordered(
+        detail::ReorderScratch<T>& scratch,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const TimeMap& map,
+        const double* const t,
+        const size_t tistart,
+        const size_t tistop,
+        std::complex<T>* out,
+        Op& op
+    ){
+        const size_t n = tistop - tistart;
+
+        // The plain store scatters straight into out; any other op is handed the outputs afterwards, in order
+        const bool plain = std::is_same<Op, detail::StoreOutput<T>>::value;
+        if (!plain)
+            scratch.outputs.resize(n);
+        std::complex<T>* const ys = plain ? out + tistart : scratch.outputs.data();
+
+        T w;
+        index_t jmin = std::numeric_limits<index_t>::max();
+        index_t jmax = -1;
+        size_t valid = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            const index_t j = interrim_index(t[tistart + k], map, w);
+            if (j < 0)
+                continue;
+
+            ys[k] = w;
+            valid++;
+            jmin = j < jmin ? j : jmin;
+            jmax = j > jmax ? j : jmax;
+        }
+        UFL_STAT(thread_stats().outputs += valid;)
+        UFL_STAT(thread_stats().skipped += n - valid;)
+        if (valid == 0)
+            return;
+
+        const int offset_bits = detail::bit_width(n - 1);
+        const int index_bits = detail::bit_width(static_cast<uint64_t>(jmax - jmin));
+        const int dropped = std::max(0, offset_bits + index_bits - 64);
+
+        std::vector<uint64_t>& keys = scratch.keys;
+        keys.resize(valid);
+        size_t v = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            const index_t j = interrim_index(t[tistart + k], map, w);
+            if (j >= 0)
+                keys[v++] = (static_cast<uint64_t>(j - jmin) >> dropped) << offset_bits | k;
+        }
+        detail::radix_sort(keys, scratch.spare, offset_bits, offset_bits + index_bits - dropped, scratch.count, scratch.starts);
+
+        const uint64_t offset_mask = offset_bits == 64 ? ~uint64_t(0) : (uint64_t(1) << offset_bits) - 1;
+        index_t jprev = -2;
+        std::complex<T> xj1, xj2;
+        for (size_t r = 0; r < valid; r++)
+        {
+            // The slots are scattered, so fetch them well ahead of the walk
+            if (r + reorder_prefetch < valid)
+                UFL_PREFETCH(ys + (keys[r + reorder_prefetch] & offset_mask));
+
+            const uint64_t key = keys[r];
+            const size_t k = static_cast<size_t>(key & offset_mask);
+            const index_t j = dropped == 0
+                ? jmin + static_cast<index_t>(key >> offset_bits)
+                : static_cast<index_t>(t[tistart + k] * map.scale);
+            advance_interrim_pair(j, jprev, xj1, xj2, in, in_length);
+            ys[k] = xj1 + (xj2 - xj1) * ys[k].real();
+        }
+
+        if (plain)
+            return;
+
+        detail::EpilogueStage<T, Op> stage(op, t, out);
+        for (size_t k = 0; k < n; k++)
+            if (interrim_index(t[tistart + k], map, w) >= 0)
+                stage.push(tistart + k, ys[k]);
+    }
+
+    // Maps the outputs [tistart, tistop) onto tiles of interrim samples and
+    // returns the strategy to use; forced always plans the tiles and returns Block
+    Strategy plan_blocks(
+        const double* const t,
+        const size_t tistart,
+        const size_t tistop,
+        const TimeMap& map,
+        const bool forced,
+        BlockPlan& plan
+    ){
+        const size_t n = tistop - tistart;
+        plan.js.resize(n);
+        plan.ws.resize(n);
+
+        index_t jmin = std::numeric_limits<index_t>::max();
+        index_t jmax = -1;
+        plan.valid = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            const index_t j = interrim_index(t[tistart + k], map, plan.ws[k]);
+            plan.js[k] = j;
+            if (j < 0)
+                continue;
+
+            plan.valid++;
+            jmin = j < jmin ? j : jmin;
+            jmax = j > jmax ? j : jmax;
+        }
+        if (plan.valid == 0)
+            return Strategy::PerPoint;
+
+        // A chunk this sparse would never be blocked, and its tile map would be mostly empty
+        plan.jbase = jmin;
+        const size_t ntiles = static_cast<size_t>(jmax + 1 - jmin) / block_tile + 1;
+        if (!forced && ntiles > 4 * plan.valid + 64)
+            return Strategy::PerPoint;
+
+        plan.slots.assign(ntiles, -1);
+        plan.touched = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            if (plan.js[k] < 0)
+                continue;
+
+            // Both interrim samples of the lerp, which may straddle two tiles
+            for (index_t jj = plan.js[k]; jj <= plan.js[k] + 1; jj++)
+            {
+                int& slot = plan.slots[(jj - plan.jbase) / block_tile];
+                if (slot < 0)
+                    slot = static_cast<int>(plan.touched++);
+            }
+        }
+
+        if (forced)
+            return Strategy::Block;
+
+        const double density = static_cast<double>(plan.valid) / (static_cast<double>(plan.touched) * block_tile);
+        if (density < m_block_density)
+            return Strategy::PerPoint;
+
+        // Per-point spends 2 dot products per output, blocks 1 / density; the saving has to pay
+        // for gathering from the tile buffer, which is far more expensive once it spills out of cache
+        const bool resident = plan.touched * block_tile * sizeof(std::complex<T>) <= block_cache_bytes;
+        const double saved_macs = m_phase_len * (2.0 - 1.0 / density);
+        return saved_macs >= (resident ? 8.0 : 64.0) ? Strategy::Block : Strategy::PerPoint;
+    }
+
+    // Block engine: evaluates every touched tile once, then lerps each output from the tiles
+    template <typename Op>
+    void interpolate_blocks(
+        const BlockPlan& plan,
+        Workspace& work,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double* const t,
+        const size_t tistart,
+        const size_t tistop,
+        std::complex<T>* out,
+        Op& op
+    ){
+        UFL_STAT(thread_stats().outputs += plan.valid;)
+        UFL_STAT(thread_stats().skipped += (tistop - tistart) - plan.valid;)
+
+        // Tiles go by runs of consecutive touched ones, in pieces of at most one overlap-save block;
+        // a piece long enough to pay for its transforms is done by overlap-save
+        std::vector<std::complex<T>>& interrim = work.tiles;
+        interrim.resize(plan.touched * block_tile);
+        const size_t piece_tiles = fft_piece_tiles();
+        for (size_t tile = 0; tile < plan.slots.size(); )
+        {
+            if (plan.slots[tile] < 0)
+            {
+                tile++;
+                continue;
+            }
+
+            size_t end = tile + 1;
+            while (end < plan.slots.size() && plan.slots[end] >= 0 && end - tile < piece_tiles)
+                end++;
+
+            const index_t j0 = plan.jbase + static_cast<index_t>(tile) * block_tile;
+            const size_t count = (end - tile) * block_tile;
+            if (fft_pays(j0, count, 1.0))
+            {
+                std::vector<std::complex<T>>& piece = work.span.xs;
+                piece.resize(count);
+                m_fft.run(j0, count, in, in_length, piece.data(), work.span.ws);
+                UFL_STAT(thread_stats().interrim += count;)
+                for (size_t k = tile; k < end; k++)
+                    std::copy(piece.begin() + (k - tile) * block_tile, piece.begin() + (k - tile + 1) * block_tile,
+                              interrim.begin() + static_cast<size_t>(plan.slots[k]) * block_tile);
+            }
+            else
+            {
+                for (size_t k = tile; k < end; k++)
+                {
+                    calculate_interrim_block(
+                        plan.jbase + static_cast<index_t>(k) * block_tile,
+                        block_tile,
+                        in,
+                        in_length,
+                        interrim.data() + static_cast<size_t>(plan.slots[k]) * block_tile
+                    );
+                }
+            }
+            tile = end;
+        }
+
+        detail::EpilogueStage<T, Op> stage(op, t, out);
+        for (size_t k = 0; k < tistop - tistart; k++)
+        {
+            const index_t j = plan.js[k];
+            if (j < 0)
+                continue;
+
+            // Both interrim samples of the lerp, which may straddle two tiles
+            const index_t rel1 = j - plan.jbase;
+            const index_t rel2 = rel1 + 1;
+            const std::complex<T>& xj1 = interrim[static_cast<size_t>(plan.slots[rel1 / block_tile]) * block_tile + rel1 % block_tile];
+            const std::complex<T>& xj2 = interrim[static_cast<size_t>(plan.slots[rel2 / block_tile]) * block_tile + rel2 % block_tile];
+            stage.push(tistart + k, xj1 + (xj2 - xj1) * plan.ws[k]);
+        }
+    }
+
+    InterrimCache<T> m_cache;
+    std::vector<index_t> m_cache_js;
+    std::vector<T> m_cache_ws;
+    std::vector<index_t> m_cache_missing;
+
+    // interpolate_array() through the interrim cache: index every output, then serially find the tiles
+    // and the samples not computed yet, and compute those and lerp from the cache on the threads.
+    // Returns false, having written nothing, if the call needs more tiles than the cache holds.
+    template <typename Op>
+    bool interpolate_cached(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const TimeMap& map,
+        const double* const t,
+        const size_t out_length,
+        std::complex<T>* out,
+        Op& op
+    ){
+        constexpr int tile = InterrimCache<T>::tile;
+        m_cache.bind(in, in_length, (in_length * m_up + 1) / tile + 1);
+
+        m_cache_js.resize(out_length);
+        m_cache_ws.resize(out_length);
+        run_threads([&](int tidx){
+            const size_t tistart = tidx * out_length / m_threads;
+            const size_t tistop = (tidx + 1) * out_length / m_threads;
+            for (size_t i = tistart; i < tistop; i++)
+                m_cache_js[i] = interrim_index(t[i], map, m_cache_ws[i]);
+        });
+
+        m_cache.begin_call();
+        for (size_t i = 0; i < out_length; i++)
+        {
+            const index_t j = m_cache_js[i];
+            if (j < 0)
+                continue;
+            m_cache.need(j / tile);
+            m_cache.need((j + 1) / tile);
+        }
+        if (!m_cache.acquire())
+            return false;
+
+        m_cache_missing.clear();
+        for (size_t i = 0; i < out_length; i++)
+        {
+            const index_t j = m_cache_js[i];
+            if (j < 0)
+                continue;
+            if (m_cache.claim(j))
+                m_cache_missing.push_back(j);
+            if (m_cache.claim(j + 1))
+                m_cache_missing.push_back(j + 1);
+        }
+
+        // Missing samples are computed in chunks of a tile's worth, each into its own place in the cache
+        const size_t chunks = (m_cache_missing.size() + tile - 1) / tile;
+        run_chunks(chunks, [&](int c){
+            const size_t mstop = std::min(m_cache_missing.size(), (c + 1) * static_cast<size_t>(tile));
+            for (size_t m = c * static_cast<size_t>(tile); m < mstop; m++)
+                m_cache.sample(m_cache_missing[m]) = derived().calculate_interrim_sample(m_cache_missing[m], in, in_length);
+        });
+
+        detail::EpilogueParts<Op> parts(op, m_threads, m_forks);
+        run_threads([&](int tidx){
+            const size_t tistart = tidx * out_length / m_threads;
+            const size_t tistop = (tidx + 1) * out_length / m_threads;
+            detail::EpilogueStage<T, Op> stage(parts[tidx], t, out);
+            UFL_STAT(size_t skipped = 0;)
+            for (size_t i = tistart; i < tistop; i++)
+            {
+                const index_t j = m_cache_js[i];
+                if (j < 0)
+                {
+                    UFL_STAT(skipped++;)
+                    continue;
+                }
+
+                const std::complex<T>& xj1 = m_cache.sample(j);
+                const std::complex<T>& xj2 = m_cache.sample(j + 1);
+                stage.push(i, xj1 + (xj2 - xj1) * m_cache_ws[i]);
+            }
+            UFL_STAT(thread_stats().outputs += (tistop - tistart) - skipped;)
+            UFL_STAT(thread_stats().skipped += skipped;)
+        });
+        parts.join(op);
+        return true;
+    }
+
+    // Interrim samples of a forward walk, computed a transform block at a time by the overlap-save engine
+    struct InterrimSpan
+    {
+        index_t j0 = 0;
+        index_t jend = 0;       // samples [j0, jend) are held
+        index_t jstop = 0;      // the walk needs none from here on
+        std::vector<std::complex<T>> xs;
+        typename OverlapSave<T>::Workspace ws;
+    };
+
+    // Whether count interrim samples from j0 on, each of which dot products would spend share of a full
+    // evaluation on, are cheaper from the overlap-save engine, counting the unused part of its blocks
+    bool fft_pays(const index_t j0, const size_t count, const double share) const
+    {
+        if (!m_fft.ready() || count == 0)
+            return false;
+
+        const double direct = share * m_phase_len * static_cast<double>(count);
+        const double fft = static_cast<double>(m_fft_crossover) * m_fft.blocks(j0, count) * m_fft.block() * m_up;
+        return direct >= fft;
+    }
+
+    // Tiles of the block engine that fit one overlap-save block, however they fall on input positions
+    size_t fft_piece_tiles() const
+    {
+        if (!m_fft.ready())
+            return std::numeric_limits<size_t>::max();
+        const size_t fit = (m_fft.block() - 2) * static_cast<size_t>(m_up) / block_tile;
+        return fit > 0 ? fit : 1;
+    }
+
+    // Largest span of interrim samples the overlap-save engine is asked for at once
+    size_t fft_span_length() const
+    {
+        return std::max(m_fft.block() * static_cast<size_t>(m_up), static_cast<size_t>(block_tile));
+    }
+
+    // Whether a walk of outputs over interrim samples [jfirst, jlast + 1] reads them from spans;
+    // if so, readies span for the walk
+    bool fft_walk(const index_t jfirst, const index_t jlast, const size_t outputs, InterrimSpan& span) const
+    {
+        // Dot products spend up to two samples per output, but never one sample twice
+        const size_t count = static_cast<size_t>(jlast - jfirst) + 2;
+        const double share = std::min(1.0, 2.0 * static_cast<double>(outputs) / static_cast<double>(count));
+        if (!fft_pays(jfirst, count, share))
+            return false;
+
+        span.j0 = 0;
+        span.jend = 0;
+        span.jstop = jlast + 2;
+        return true;
+    }
+
+    // Interrim samples j and j + 1 of a span walk; when they are not both held,
+    // the next span is computed from j's input position on
+    void span_interrim_pair(
+        const index_t j,
+        InterrimSpan& span,
+        std::complex<T>& xj1,
+        std::complex<T>& xj2,
+        const std::complex<TIn>* const in,
+        const size_t in_length
+    ){
+        if (j < span.j0 || j + 1 >= span.jend)
+        {
+            span.j0 = j - j % m_up;
+            span.jend = std::min(span.jstop, span.j0 + static_cast<index_t>(m_fft.block()) * m_up);
+            const size_t count = static_cast<size_t>(span.jend - span.j0);
+            span.xs.resize(count);
+            m_fft.run(span.j0, count, in, in_length, span.xs.data(), span.ws);
+            UFL_STAT(thread_stats().interrim += count;)
+        }
+        xj1 = span.xs[static_cast<size_t>(j - span.j0)];
+        xj2 = span.xs[static_cast<size_t>(j + 1 - span.j0)];
+    }
+
+    // Interrim pair carried along a uniform grid
+    struct UniformCarry
+    {
+        index_t jprev = -2;
+        std::complex<T> xj1, xj2;
+    };
+
+    // The next n outputs of a uniform grid from position pos into dst, advancing pos.
+    // Shared by every epilogue, so the hot loop compiles the same whatever follows it.
+    void lerp_uniform_run(
+        detail::Phase64& pos,
+        const detail::Phase64& step,
+        const size_t n,
+        UniformCarry& carry,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        std::complex<T>* dst
+    ){
+        index_t jprev = carry.jprev;
+        std::complex<T> xj1 = carry.xj1, xj2 = carry.xj2;
+        for (size_t k = 0; k < n; k++)
+        {
+            const index_t j = pos.whole;
+            advance_interrim_pair(j, jprev, xj1, xj2, in, in_length);
+
+            dst[k] = xj1 + (xj2 - xj1) * static_cast<T>(pos.fraction());
+            pos.add(step);
+        }
+        carry.jprev = jprev;
+        carry.xj1 = xj1;
+        carry.xj2 = xj2;
+    }
+
+    // Same, with the interrim samples read from overlap-save spans
+    void lerp_uniform_span(
+        detail::Phase64& pos,
+        const detail::Phase64& step,
+        const size_t n,
+        InterrimSpan& span,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        std::complex<T>* dst
+    ){
+        std::complex<T> xj1, xj2;
+        for (size_t k = 0; k < n; k++)
+        {
+            span_interrim_pair(pos.whole, span, xj1, xj2, in, in_length);
+
+            dst[k] = xj1 + (xj2 - xj1) * static_cast<T>(pos.fraction());
+            pos.add(step);
+        }
+    }
+
+    // Outputs per chunk of the multi-hypothesis path; bounds the shared interrim buffer
+    static constexpr size_t hypothesis_chunk = 2048;
+
+    // Buffers of the multi-hypothesis path, one set per thread, kept between chunks and calls
+    struct HypothesisScratch
+    {
+        std::vector<index_t> js;
+        std::vector<T> ws;
+        std::vector<char> needed;
+        std::vector<std::complex<T>> interrim;
+    };
+
+    // Everything one thread needs during a call, kept between calls so that steady-state calls do not allocate.
+    // One per thread that may take part, indexed like the pool's workers; see reserve()
+    struct Workspace
+    {
+        BlockPlan plan;
+        std::vector<std::complex<T>> tiles;     // touched tiles of the block engine
+        InterrimSpan span;                      // overlap-save spans, and pieces of the block engine
+        detail::ReorderScratch<T> reorder;
+        HypothesisScratch hypothesis;
+        std::vector<std::complex<T>> channels;  // interrim pair of the interleaved path
+    };
+    std::vector<Workspace> m_workspaces = std::vector<Workspace>(1);
+    // Outputs per call the workspaces are sized for
+    size_t m_reserved = 0;
+    detail::ForkStore m_forks;
+
+    // Workspace of the thread running the current task
+    Workspace& workspace()
+    {
+        return m_workspaces[m_threads > 1 && m_pool ? ThreadPool::current_worker() : 0];
+    }
+
+    // Slots the pool's threads may ask for, the caller's first
+    size_t workspace_slots() const
+    {
+        return m_pool ? static_cast<size_t>(m_pool->size()) + 1 : 1;
+    }
+
+    // A shared pool may have been resized by another interpolator since
+    void claim_workspaces()
+    {
+        if (m_workspaces.size() < workspace_slots())
+            size_workspaces();
+    }
+
+    // Gives every thread that may take part a workspace, and reserves what calls of up to m_reserved
+    // outputs need in each: spans of the overlap-save engine, and whatever the strategy keeps per output.
+    // The tile buffer is sized for the densest block plan Auto accepts; forced blocks may still grow it.
+    void size_workspaces()
+    {
+        if (m_workspaces.size() < workspace_slots())
+            m_workspaces.resize(workspace_slots());
+
+        const size_t slice = m_reserved / static_cast<size_t>(m_threads) + 1;
+        for (Workspace& work : m_workspaces)
+        {
+            if (m_fft.ready())
+            {
+                work.span.xs.reserve(fft_span_length());
+                work.span.ws.x.reserve(m_fft.size());
+                work.span.ws.y.reserve(m_fft.size());
+            }
+            if (m_reserved == 0)
+                continue;
+
+            if (m_strategy == Strategy::Reorder)
+            {
+                work.reorder.keys.reserve(slice);
+                work.reorder.spare.reserve(slice);
+                work.reorder.outputs.reserve(slice);
+                work.reorder.count.reserve(size_t(1) << detail::max_radix_digit);
+                work.reorder.starts.reserve((size_t(1) << detail::max_radix_top) + 1);
+            }
+            else if (m_strategy != Strategy::PerPoint)
+            {
+                // Auto plans at most 4 tiles per output, plus 64, and blocks at least m_block_density outputs per tile sample
+                const size_t ntiles = 4 * slice + 64 + 1;
+                size_t touched = std::min(ntiles, 2 * slice);
+                if (m_block_density > 0)
+                    touched = std::min(touched, static_cast<size_t>(slice / (m_block_density * block_tile)) + 1);
+                work.plan.js.reserve(slice);
+                work.plan.ws.reserve(slice);
+                work.plan.slots.reserve(ntiles);
+                work.tiles.reserve(touched * block_tile);
+            }
+        }
+    }
+
+    // Outputs at time(k, i) into out[k * out_length + i], for all hypotheses k, chunk by chunk of i
+    template <typename TimeFn>
+    void interpolate_hypotheses(
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const double in_T,
+        const size_t out_length,
+        const size_t hypotheses,
+        TimeFn time,
+        std::complex<T>* out
+    ){
+        begin_call();
+        const TimeMap map = time_map(in_T, in_length);
+        const size_t chunks = (out_length + hypothesis_chunk - 1) / hypothesis_chunk;
+
+        run_chunks(chunks, [&](int c){
+            const size_t i0 = c * hypothesis_chunk;
+            const size_t n = std::min(hypothesis_chunk, out_length - i0);
+            HypothesisScratch& scratch = workspace().hypothesis;
+
+            // Interrim index and weight of every output in the chunk, row by row
+            std::vector<index_t>& js = scratch.js;
+            std::vector<T>& ws = scratch.ws;
+            js.resize(hypotheses * n);
+            ws.resize(hypotheses * n);
+            index_t jmin = std::numeric_limits<index_t>::max();
+            index_t jmax = -1;
+            size_t valid = 0;
+            for (size_t k = 0; k < hypotheses; k++)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    const index_t j = interrim_index(time(k, i0 + i), map, ws[k * n + i]);
+                    js[k * n + i] = j;
+                    if (j < 0)
+                        continue;
+
+                    valid++;
+                    jmin = j < jmin ? j : jmin;
+                    jmax = j > jmax ? j : jmax;
+                }
+            }
+            UFL_STAT(thread_stats().outputs += valid;)
+            UFL_STAT(thread_stats().skipped += hypotheses * n - valid;)
+            if (valid == 0)
+                return;
+
+            // Scattered times would need a buffer over much more than they use;
+            // walk them output by output instead, carrying the pair across neighbouring hypotheses
+            const size_t range = static_cast<size_t>(jmax - jmin) + 2;
+            if (range > 16 * valid + 4 * block_tile)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    index_t jprev = -2;
+                    std::complex<T> xj1, xj2;
+                    for (size_t k = 0; k < hypotheses; k++)
+                    {
+                        const index_t j = js[k * n + i];
+                        if (j < 0)
+                            continue;
+
+                        advance_interrim_pair(j, jprev, xj1, xj2, in, in_length);
+                        out[k * out_length + i0 + i] = xj1 + (xj2 - xj1) * ws[k * n + i];
+                    }
+                }
+                return;
+            }
+
+            // Otherwise evaluate each needed interrim sample once into a buffer over [jmin, jmax + 1]
+            std::vector<char>& needed = scratch.needed;
+            needed.assign(range, 0);
+            for (size_t m = 0; m < hypotheses * n; m++)
+            {
+                if (js[m] < 0)
+                    continue;
+                needed[js[m] - jmin] = 1;
+                needed[js[m] - jmin + 1] = 1;
+            }
+
+            std::vector<std::complex<T>>& interrim = scratch.interrim;
+            interrim.resize(range);
+            for (size_t r = 0; r < range; r++)
+                if (needed[r])
+                    interrim[r] = derived().calculate_interrim_sample(jmin + static_cast<index_t>(r), in, in_length);
+
+            for (size_t k = 0; k < hypotheses; k++)
+            {
+                std::complex<T>* row = out + k * out_length + i0;
+                for (size_t i = 0; i < n; i++)
+                {
+                    const index_t j = js[k * n + i];
+                    if (j < 0)
+                        continue;
+
+                    const std::complex<T>& xj1 = interrim[j - jmin];
+                    const std::complex<T>& xj2 = interrim[j - jmin + 1];
+                    row[i] = xj1 + (xj2 - xj1) * ws[k * n + i];
+                }
+            }
+        });
+        end_stats();
+    }
+
+    // Range of outputs worth visiting: the bisected valid span for sorted times, otherwise everything.
+    // Returns whether t is treated as sorted.
+    bool valid_span(
+        const double* const t,
+        const size_t out_length,
+        const TimeMap& map,
+        size_t& istart,
+        size_t& istop
+    ){
+        istart = 0;
+        istop = out_length;
+
+        const bool sorted = m_time_order == TimeOrder::Sorted ||
+            (m_time_order == TimeOrder::Auto && std::is_sorted(t, t + out_length));
+        if (sorted)
+        {
+            istart = std::lower_bound(t, t + out_length, 0.0) - t;
+            istop = std::upper_bound(t + istart, t + out_length, map.t_max) - t;
+        }
+        return sorted;
+    }
+
+    // Interrim sample number for time ti, and the lerp weight towards the next one;
+    // -1 if ti is outside the upsampled range.
+    // Every path indexes through here, or the same multiply, so they agree to the bit.
+    index_t interrim_index(
+        const double ti,
+        const TimeMap& map,
+        T& weight
+    ) const
+    {
+        if (ti < 0 || ti > map.t_max)
+            return -1;
+
+        const double jd = ti * map.scale;
+        const index_t j = static_cast<index_t>(jd);
+        weight = static_cast<T>(jd - static_cast<double>(j));
+        return j;
+    }
+
+    // Same for an exact position p in input samples: the interrim position p * m_up is split
+    // into its integer part and a 64-bit fraction without rounding
+    index_t interrim_index(
+        const FixedTime& p,
+        const size_t in_length,
+        T& weight
+    ) const
+    {
+        uint64_t lo;
+        const uint64_t hi = detail::mul_64x64(p.frac, static_cast<uint64_t>(m_up), lo);
+        const index_t j = p.whole * m_up + static_cast<index_t>(hi);
+        const index_t last = static_cast<index_t>(in_length * m_up) - 1;
+        if (j < 0 || j > last || (j == last && lo != 0))
+            return -1;
+
+        weight = static_cast<T>(static_cast<double>(lo) * 0x1p-64);
+        return j;
+    }
+
+    // Largest number of channel groups, dividing the thread count, that still leaves a channel per group
+    int channel_parts(const size_t channels) const
+    {
+        int parts = 1;
+        for (int d = 1; d <= m_threads; d++)
+            if (m_threads % d == 0 && static_cast<size_t>(d) <= channels)
+                parts = d;
+        return parts;
+    }
+
+    // Moves the carried interrim samples (xj1, xj2) from jprev, jprev+1 to j, j+1,
+    // reusing whatever overlaps; j must not be less than jprev
+    void advance_interrim_pair(
+        const index_t j,
+        index_t& jprev,
+        std::complex<T>& xj1,
+        std::complex<T>& xj2,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const size_t in_offset = 0
+    ){
+        if (j == jprev + 1)
+        {
+            xj1 = xj2;
+            xj2 = derived().calculate_interrim_sample(j+1, in, in_length, in_offset);
+        }
+        else if (j != jprev)
+        {
+            xj1 = derived().calculate_interrim_sample(j, in, in_length, in_offset);
+            xj2 = derived().calculate_interrim_sample(j+1, in, in_length, in_offset);
+        }
+        jprev = j;
+    }
+
+    // Consecutive interrim samples [j0, j0 + count) into xj
+    void calculate_interrim_block(
+        const index_t j0,
+        const int count,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        std::complex<T>* xj
+    ){
+        for (int k = 0; k < count; k++)
+            xj[k] = derived().calculate_interrim_sample(j0 + k, in, in_length);
+    }
+
+    // Interrim sample j for width interleaved channels at once, written to xj[0, width).
+    // Row k of the input starts at in + k * stride.
+    void calculate_interrim_interleaved(
+        const index_t j,
+        const std::complex<TIn>* const in,
+        const size_t stride,
+        const size_t width,
+        const size_t in_length,
+        std::complex<T>* xj
+    ){
+        const int phase = static_cast<int>(j % m_up);
+        const index_t j_in = j / m_up;
+        const index_t start = j_in - m_phase_len + 1;
+        index_t zstart = start < 0 ? 0 : start;
+        index_t zend = j_in >= static_cast<index_t>(in_length) ? static_cast<index_t>(in_length) - 1 : j_in;
+
+        const T* const taps = m_bank.data() + static_cast<size_t>(phase) * m_phase_len;
+
+        // Work on the real and imaginary parts as one flat array so the channel loop vectorises
+        UFL_STAT(thread_stats().interrim += width;)
+        UFL_STAT(thread_stats().macs += width * multiplies(phase, start, zstart, zend, j_in);)
+
+        T* acc = reinterpret_cast<T*>(xj);
+        std::fill(acc, acc + 2 * width, T(0));
+
+        // Folded over the mirrored window when it lies inside the signal
+        const int fold = m_fold_start[phase];
+        if (fold >= 0 && zstart <= start + fold && zend == j_in)
+        {
+            const index_t first = start + fold;
+            const index_t len = j_in - first + 1;
+            for (index_t r = 0; r < len / 2; r++)
+            {
+                const T tap = taps[fold + r];
+                const TIn* front = reinterpret_cast<const TIn*>(in + static_cast<size_t>(first + r) * stride);
+                const TIn* back = reinterpret_cast<const TIn*>(in + static_cast<size_t>(j_in - r) * stride);
+                for (size_t c = 0; c < 2 * width; c++)
+                    acc[c] += (static_cast<T>(front[c]) + m_fold_sign * static_cast<T>(back[c])) * tap;
+            }
+            zstart = first + len / 2;
+            zend = j_in - len / 2;
+        }
+
+        for (index_t i = zstart; i <= zend; i++)
+        {
+            const T tap = taps[i - start];
+            const TIn* row = reinterpret_cast<const TIn*>(in + static_cast<size_t>(i) * stride);
+            for (size_t c = 0; c < 2 * width; c++)
+                acc[c] += static_cast<T>(row[c]) * tap;
+        }
+    }
+
+    // Multiplies spent on the interrim sample of the given phase whose window [start, j_in] is clamped to [zstart, zend]
+    size_t multiplies(const int phase, const index_t start, const index_t zstart, const index_t zend, const index_t j_in) const
+    {
+        const int fold = m_fold_start[phase];
+        if (fold >= 0 && zstart <= start + fold && zend == j_in)
+            return static_cast<size_t>(m_phase_len - fold + 1) / 2;
+        return zstart <= zend ? static_cast<size_t>(zend - zstart + 1) : 0;
+    }
+
+    // Helper method.
+    // in_length is the length of the whole signal, used for the zero padding at its end;
+    // in points at input sample in_offset, so a window of a longer signal can be passed
+    // as long as it covers every sample this interrim sample reads.
+    std::complex<T> calculate_interrim_sample(
+        const index_t j,
+        const std::complex<TIn>* const in,
+        const size_t in_length,
+        const size_t in_offset = 0
+    ){
+        // Interrim sample j sits at phase (j % m_up) after input sample (j / m_up);
+        // every other tap lands on a zero-stuffed sample, so only that phase's sub-filter is needed
+        const int phase = static_cast<int>(j % m_up);
+        const index_t j_in = j / m_up;
+
+        // We need to perform the dot product over the input from [j_in-m_phase_len+1, j_in]
+        index_t start = j_in - m_phase_len + 1; // keep this so we can reference the sub-filter index
+        // Enforce starting at 0
+        index_t zstart = start < 0 ? 0 : start;
+        // Enforce ending to be size of the input
+        index_t zend = j_in >= static_cast<index_t>(in_length) ? static_cast<index_t>(in_length) - 1 : j_in;
+
+        if (zstart <= zend)
+            DEBUG_PRINT("==Interrim %lld: phase %d, dot prod from input %lld(%lld) to %lld(%lld)\n",
+                (long long)j, phase, (long long)start, (long long)zstart, (long long)j_in, (long long)zend);
+        else
+            DEBUG_PRINT("==Interrim %lld: no valid dot prod\n", (long long)j);
+
+        UFL_STAT(thread_stats().interrim++;)
+        UFL_STAT(thread_stats().macs += multiplies(phase, start, zstart, zend, j_in);)
+
+        // Finally the dot product, forwards over the contiguous input;
+        // folded when the sub-filter mirrors itself and its window lies inside the signal
+        std::complex<T> xj = {0, 0};
+        const int fold = m_fold_start[phase];
+        if (fold >= 0 && zstart <= start + fold && zend == j_in)
+        {
+            xj = m_fold(
+                m_bank.data() + static_cast<size_t>(phase) * m_phase_len + fold,
+                in + (start + fold - static_cast<index_t>(in_offset)),
+                static_cast<size_t>(m_phase_len - fold),
+                m_fold_sign
+            );
+        }
+        else if (zstart <= zend)
+        {
+            xj = m_dot(
+                m_bank.data() + static_cast<size_t>(phase) * m_phase_len + (zstart - start),
+                in + (zstart - static_cast<index_t>(in_offset)),
+                static_cast<size_t>(zend - zstart + 1)
+            );
         }
 
-        DEBUG_PRINT("==Dot prod for interrim %d complete\n\n", j);
+        DEBUG_PRINT("==Dot prod for interrim %lld complete\n\n", (long long)j);
 
 
         return xj;
@@ -216,8 +2177,8 @@ protected:
 
 // CRTP definition of actual class
 // This is the actual class that should be used.
-template <typename T>
-class UpfirLerp : public BaseUpfirLerp<T, UpfirLerp<T>>
+template <typename T, typename TIn = T>
+class UpfirLerp : public BaseUpfirLerp<T, UpfirLerp<T, TIn>, TIn>
 {
 
 };
@@ -3,78 +3,407 @@
 
 #include "mex.h"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <limits>
+#include <cmath>
 
-/* The gateway function */
-void mexFunction( int nlhs, mxArray *plhs[],
-                  int nrhs, const mxArray *prhs[])
+// Usage, stateless (a new interpolator per call, single-threaded):
+//   y = matufl(up, taps, x, T, t)
+//   y = matufl(up, taps, x, T, t0, dt, N)
+//
+// Usage, handle-based (taps, prepared bank and worker threads are kept between calls):
+//   h = matufl('create', up, taps[, threads])
+//   matufl('configure', h, 'up', up, 'taps', taps, 'threads', threads)  (any subset of the pairs)
+//   y = matufl('interpolate', h, x, T, t)
+//   y = matufl('interpolate', h, x, T, t0, dt, N)
+//   matufl('destroy', h)
+//
+// Taps are real single or double, which selects the precision of the interpolator and of y.
+// x is complex of the same class, or complex int16 (read directly, without a conversion copy).
+
+// Checks the input, period and time arguments of an interpolation: x, T, t or x, T, t0, dt, N
+static void check_interpolate_args(int nargs, const mxArray *args[], bool is_double)
 {
-    /* check for proper number of arguments */
-    if(nrhs!=5) {
-        mexErrMsgIdAndTxt(
-            "MyToolbox:arrayProduct:nrhs",
-            "5 inputs required: upsample rate, taps vec, input vec, input period, interpolated time vec.");
+    // Check input vector, must be complex of the taps' class or complex int16
+    if ( !((is_double ? mxIsDouble(args[0]) : mxIsSingle(args[0])) || mxIsInt16(args[0])) || !mxIsComplex(args[0]) )
+    {
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notSingle",
+            is_double ? "input vec must be complex double-precision or complex int16."
+                      : "input vec must be complex single-precision or complex int16.");
     }
-    if(nlhs!=1) {
-        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nlhs","One output required.");
+
+    // Check input sample period, must be scalar double
+    if ( !mxIsDouble(args[1]) || mxGetNumberOfElements(args[1])!= 1 || mxIsComplex(args[1]))
+    {
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notDouble","input sample period must be a real scalar double.");
     }
-    // Check upsample rate
-    if ( mxGetNumberOfElements(prhs[0]) != 1 || mxIsComplex(prhs[0]))
+
+    if (nargs == 3)
+    {
+        // Check interpolated time vector, must be double precision
+        if ( !mxIsDouble(args[2]) || mxIsComplex(args[2]))
+        {
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notDouble","interpolated time vec must be real double-precision.");
+        }
+    }
+    else
+    {
+        // Check uniform grid definition, t0 and dt must be scalar doubles, N a real scalar
+        for (int i = 2; i < 4; i++)
+        {
+            if ( !mxIsDouble(args[i]) || mxGetNumberOfElements(args[i]) != 1 || mxIsComplex(args[i]))
+            {
+                mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notDouble","t0 and dt must be real scalar doubles.");
+            }
+        }
+        if ( mxGetNumberOfElements(args[4]) != 1 || mxIsComplex(args[4]) || mxGetScalar(args[4]) < 0)
+        {
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notScalar","N must be a non-negative real scalar.");
+        }
+        if ( !(mxGetScalar(args[3]) > 0) )
+        {
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notPositive","dt must be positive.");
+        }
+    }
+}
+
+static int check_up_rate(const mxArray *arg)
+{
+    if ( mxGetNumberOfElements(arg) != 1 || mxIsComplex(arg))
     {
         mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notScalar","upsample rate must be a real scalar.");
     }
+    // Checked before the cast, which would turn fractions, NaN and huge values into other rates
+    const double up = mxGetScalar(arg);
+    if ( !(up >= 1 && up <= std::numeric_limits<int>::max()) || up != std::floor(up))
+    {
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notPositive","upsample rate must be an integer of at least 1.");
+    }
+    return static_cast<int>(up);
+}
 
-    // Check taps vector, must be single precision
-    if ( !mxIsSingle(prhs[1]) || mxIsComplex(prhs[1]))
+static void check_taps(const mxArray *arg)
+{
+    // Check taps vector, single or double precision
+    if ( !(mxIsSingle(arg) || mxIsDouble(arg)) || mxIsComplex(arg))
     {
-        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notSingle","taps vec must be real single-precision.");
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notSingle","taps vec must be real single or double precision.");
     }
+}
 
-    // Check input vector, must be complex singles
-    if ( !mxIsSingle(prhs[2]) || !mxIsComplex(prhs[2]) )
+static int check_threads(const mxArray *arg)
+{
+    if ( mxGetNumberOfElements(arg) != 1 || mxIsComplex(arg) || mxGetScalar(arg) < 1)
     {
-        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notSingle","input vec must be complex single-precision.");
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notScalar","threads must be a positive real scalar.");
     }
+    return static_cast<int>(mxGetScalar(arg));
+}
 
-    // Check input sample period, must be scalar double
-    if ( !mxIsDouble(prhs[3]) || mxGetNumberOfElements(prhs[3])!= 1 || mxIsComplex(prhs[3]))
+template <typename T>
+const T* taps_data(const mxArray *arg);
+
+template <>
+const float* taps_data<float>(const mxArray *arg) { return reinterpret_cast<const float*>(mxGetSingles(arg)); }
+
+template <>
+const double* taps_data<double>(const mxArray *arg) { return reinterpret_cast<const double*>(mxGetDoubles(arg)); }
+
+// Runs the interpolation of args (x, T, t or x, T, t0, dt, N, already checked) and returns y
+template <typename T, typename TIn>
+mxArray* interpolate_args(ufl::UpfirLerp<T, TIn> &upfirlerp, int nargs, const mxArray *args[])
+{
+    /* create the output matrix */
+    const size_t out_length = nargs == 3 ?
+        static_cast<size_t>(mxGetNumberOfElements(args[2])) :
+        static_cast<size_t>(mxGetScalar(args[4]));
+    mxArray *result = mxCreateNumericMatrix(
+        1, out_length,
+        std::is_same<T, double>::value ? mxDOUBLE_CLASS : mxSINGLE_CLASS, mxCOMPLEX
+    );
+    std::complex<T>* out = reinterpret_cast<std::complex<T>*>(mxGetData(result));
+
+    if (nargs == 5)
     {
-        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notDouble","input sample period must be a real scalar double.");
+        upfirlerp.interpolate_uniform_array(
+            reinterpret_cast<const std::complex<TIn>*>(mxGetData(args[0])),
+            static_cast<size_t>(mxGetNumberOfElements(args[0])),
+            static_cast<double>(mxGetScalar(args[1])),
+            static_cast<double>(mxGetScalar(args[2])),
+            static_cast<double>(mxGetScalar(args[3])),
+            out_length,
+            out
+        );
+        return result;
+    }
+
+    upfirlerp.interpolate_array(
+        reinterpret_cast<const std::complex<TIn>*>(mxGetData(args[0])),
+        static_cast<size_t>(mxGetNumberOfElements(args[0])),
+        static_cast<double>(mxGetScalar(args[1])),
+        reinterpret_cast<const double*>(mxGetData(args[2])),
+        static_cast<size_t>(mxGetNumberOfElements(args[2])),
+        out
+    );
+    return result;
+}
+
+// Interpolator kept alive between calls of the handle interface
+class Instance
+{
+public:
+    virtual ~Instance() = default;
+
+    virtual bool is_double() const = 0;
+    virtual void set_up_rate(int up) = 0;
+    virtual void set_up_taps(const mxArray *taps) = 0;
+    virtual void set_threads(int threads) = 0;
+    virtual mxArray* interpolate(int nargs, const mxArray *args[]) = 0;
+};
+
+template <typename T>
+class TypedInstance : public Instance
+{
+public:
+    bool is_double() const override
+    {
+        return std::is_same<T, double>::value;
+    }
+
+    void set_up_rate(int up) override
+    {
+        m_upfirlerp.set_up_rate(up);
+        if (m_upfirlerp_int16)
+            m_upfirlerp_int16->set_up_rate(up);
+    }
+
+    void set_up_taps(const mxArray *taps) override
+    {
+        if (mxIsDouble(taps) != is_double())
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:wrongClass","taps must keep the precision the handle was created with.");
+
+        m_taps.assign(taps_data<T>(taps), taps_data<T>(taps) + mxGetNumberOfElements(taps));
+        m_upfirlerp.set_up_taps(m_taps);
+        if (m_upfirlerp_int16)
+            m_upfirlerp_int16->set_up_taps(m_taps);
+    }
+
+    void set_threads(int threads) override
+    {
+        m_upfirlerp.set_threads(threads);
+        if (m_upfirlerp_int16)
+            m_upfirlerp_int16->set_thread_pool(m_upfirlerp.get_thread_pool());
+    }
+
+    mxArray* interpolate(int nargs, const mxArray *args[]) override
+    {
+        if (!mxIsInt16(args[0]))
+            return interpolate_args(m_upfirlerp, nargs, args);
+
+        // The int16 reader is built on first use, from the same taps, and shares the worker threads
+        if (!m_upfirlerp_int16)
+        {
+            m_upfirlerp_int16.reset(new ufl::UpfirLerp<T, int16_t>());
+            m_upfirlerp_int16->set_up_rate(m_upfirlerp.get_up_rate())
+                .set_up_taps(m_taps)
+                .set_thread_pool(m_upfirlerp.get_thread_pool());
+        }
+        return interpolate_args(*m_upfirlerp_int16, nargs, args);
     }
 
-    // Check interpolated time vector, must be double precision
-    if ( !mxIsDouble(prhs[4]) || mxIsComplex(prhs[4]))
+protected:
+    std::vector<T> m_taps;
+    ufl::UpfirLerp<T> m_upfirlerp;
+    std::unique_ptr<ufl::UpfirLerp<T, int16_t>> m_upfirlerp_int16;
+};
+
+// Live handles; the mex file stays locked while any exist, so 'clear' cannot invalidate them
+static std::map<uint64_t, std::unique_ptr<Instance>> instances;
+static uint64_t next_handle = 1;
+
+static void destroy_all()
+{
+    instances.clear();
+}
+
+static Instance& find_instance(const mxArray *arg)
+{
+    if ( !mxIsUint64(arg) || mxGetNumberOfElements(arg) != 1 )
     {
-        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notDouble","interpolated time vec must be real double-precision.");
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:badHandle","handle must be a uint64 scalar returned by 'create'.");
     }
+    auto it = instances.find(*mxGetUint64s(arg));
+    if (it == instances.end())
+    {
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:badHandle","handle does not refer to a live interpolator.");
+    }
+    return *it->second;
+}
+
+static void run_command(const std::string &command, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (command == "create")
+    {
+        if (nrhs != 3 && nrhs != 4)
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nrhs","'create' takes upsample rate, taps vec and optionally threads.");
+        if (nlhs != 1)
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nlhs","'create' returns one handle.");
+
+        const int up = check_up_rate(prhs[1]);
+        check_taps(prhs[2]);
+        const int threads = nrhs == 4 ? check_threads(prhs[3]) : 1;
+
+        std::unique_ptr<Instance> instance;
+        if (mxIsDouble(prhs[2]))
+            instance.reset(new TypedInstance<double>());
+        else
+            instance.reset(new TypedInstance<float>());
+        instance->set_up_rate(up);
+        instance->set_up_taps(prhs[2]);
+        instance->set_threads(threads);
 
-    // If all okay, instantiate the class
-    ufl::UpfirLerp<float> upfirlerp;
+        if (instances.empty())
+            mexLock();
+        const uint64_t handle = next_handle++;
+        instances[handle] = std::move(instance);
+
+        plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+        *mxGetUint64s(plhs[0]) = handle;
+    }
+    else if (command == "configure")
+    {
+        if (nrhs < 2 || nrhs % 2 != 0)
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nrhs","'configure' takes a handle and name/value pairs.");
+
+        Instance &instance = find_instance(prhs[1]);
+        for (int i = 2; i < nrhs; i += 2)
+        {
+            if (!mxIsChar(prhs[i]))
+                mexErrMsgIdAndTxt("MyToolbox:arrayProduct:notChar","setting names must be char arrays.");
+
+            char *name_chars = mxArrayToString(prhs[i]);
+            const std::string name = name_chars;
+            mxFree(name_chars);
+
+            if (name == "up")
+                instance.set_up_rate(check_up_rate(prhs[i + 1]));
+            else if (name == "taps")
+            {
+                check_taps(prhs[i + 1]);
+                instance.set_up_taps(prhs[i + 1]);
+            }
+            else if (name == "threads")
+                instance.set_threads(check_threads(prhs[i + 1]));
+            else
+                mexErrMsgIdAndTxt("MyToolbox:arrayProduct:badSetting","unknown setting '%s'; expected 'up', 'taps' or 'threads'.", name.c_str());
+        }
+    }
+    else if (command == "interpolate")
+    {
+        if (nrhs != 5 && nrhs != 7)
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nrhs",
+                "'interpolate' takes a handle, input vec, input period and interpolated time vec, or t0, dt, N.");
+        if (nlhs != 1)
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nlhs","One output required.");
+
+        Instance &instance = find_instance(prhs[1]);
+        check_interpolate_args(nrhs - 2, prhs + 2, instance.is_double());
+        plhs[0] = instance.interpolate(nrhs - 2, prhs + 2);
+    }
+    else if (command == "destroy")
+    {
+        if (nrhs != 2)
+            mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nrhs","'destroy' takes a handle.");
+
+        find_instance(prhs[1]);
+        instances.erase(*mxGetUint64s(prhs[1]));
+        if (instances.empty())
+            mexUnlock();
+    }
+    else
+    {
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:badCommand",
+            "unknown command '%s'; expected 'create', 'configure', 'interpolate' or 'destroy'.", command.c_str());
+    }
+}
+
+// Stateless call: a fresh interpolator for this call only
+template <typename T, typename TIn>
+mxArray* run(int nrhs, const mxArray *prhs[])
+{
+    ufl::UpfirLerp<T, TIn> upfirlerp;
     upfirlerp.set_up_rate(
         static_cast<int>(mxGetScalar(prhs[0]))
     );
     upfirlerp.set_up_taps(
-        reinterpret_cast<float*>(mxGetSingles(prhs[1])),
+        taps_data<T>(prhs[1]),
         static_cast<size_t>(mxGetNumberOfElements(prhs[1]))
     );
+    return interpolate_args(upfirlerp, nrhs - 2, prhs + 2);
+}
 
+static void run_stateless(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* check for proper number of arguments */
+    if(nrhs!=5 && nrhs!=7) {
+        mexErrMsgIdAndTxt(
+            "MyToolbox:arrayProduct:nrhs",
+            "5 inputs required: upsample rate, taps vec, input vec, input period, interpolated time vec.\n"
+            "Or 7 inputs for a uniform output grid: upsample rate, taps vec, input vec, input period, t0, dt, N.\n"
+            "Or a command: 'create', 'configure', 'interpolate', 'destroy'.");
+    }
+    if(nlhs!=1) {
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:nlhs","One output required.");
+    }
 
-    /* create the output matrix */
-    plhs[0] = mxCreateNumericMatrix(
-        1, mxGetNumberOfElements(prhs[4]),
-        mxSINGLE_CLASS, mxCOMPLEX
-    );
-
-    /* get a pointer to the real data in the output matrix */
-    mxComplexSingle* out = mxGetComplexSingles(plhs[0]);
+    check_up_rate(prhs[0]);
+    check_taps(prhs[1]);
+    const bool is_double = mxIsDouble(prhs[1]);
+    check_interpolate_args(nrhs - 2, prhs + 2, is_double);
 
     /* call the computational routine */
-    upfirlerp.interpolate_array(
-        reinterpret_cast<const std::complex<float>*>(mxGetData(prhs[2])), 
-        static_cast<size_t>(mxGetNumberOfElements(prhs[2])),
-        static_cast<double>(mxGetScalar(prhs[3])),
-        reinterpret_cast<const double*>(mxGetData(prhs[4])), 
-        static_cast<size_t>(mxGetNumberOfElements(prhs[4])),
-        reinterpret_cast<std::complex<float>*>(out)
-    );
+    if (is_double)
+        plhs[0] = mxIsInt16(prhs[2]) ? run<double, int16_t>(nrhs, prhs) : run<double, double>(nrhs, prhs);
+    else
+        plhs[0] = mxIsInt16(prhs[2]) ? run<float, int16_t>(nrhs, prhs) : run<float, float>(nrhs, prhs);
 }
 
+/* The gateway function */
+void mexFunction( int nlhs, mxArray *plhs[],
+                  int nrhs, const mxArray *prhs[])
+{
+    static bool registered = false;
+    if (!registered)
+    {
+        mexAtExit(destroy_all);
+        registered = true;
+    }
+
+    // Library errors are reported after leaving the catch block, since mexErrMsgIdAndTxt does not return
+    std::string error;
+    try
+    {
+        if (nrhs >= 1 && mxIsChar(prhs[0]))
+        {
+            char *command_chars = mxArrayToString(prhs[0]);
+            const std::string command = command_chars;
+            mxFree(command_chars);
+            run_command(command, nlhs, plhs, nrhs, prhs);
+        }
+        else
+        {
+            run_stateless(nlhs, plhs, nrhs, prhs);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        error = e.what();
+    }
+
+    if (!error.empty())
+        mexErrMsgIdAndTxt("MyToolbox:arrayProduct:ufl", "%s", error.c_str());
+}
@@ -1,15 +1,32 @@
 #include "upfirlerp.h"
 #include <nanobind/nanobind.h>
 #include <nanobind/ndarray.h>
+#include <mutex>
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
+template <typename T>
+using OwnedArray = nb::ndarray<nb::numpy, std::complex<T>, nb::ndim<1>>;
+
+// Zero-filled array of n outputs, owned by the returned numpy array, so nothing is copied on return
+template <typename T>
+OwnedArray<T> allocate_output(size_t n, std::complex<T>*& data)
+{
+    data = new std::complex<T>[n]();
+    nb::capsule owner(data, [](void* p) noexcept {
+        delete[] static_cast<std::complex<T>*>(p);
+    });
+    return OwnedArray<T>(data, {n}, owner);
+}
+
 template <typename T>
 class Pyufl : public ufl::UpfirLerp<T>
 {
 public:
-    // Define the wrapper to numpy array
+    // Define the wrapper to numpy array.
+    // The GIL is released for the computation, so other Python threads keep running;
+    // calls on the same object from several threads are serialised.
     void interpolate_numpy(
         const nb::ndarray<std::complex<T>, nb::ndim<1>> &input,
         const double in_T,
@@ -21,27 +38,90 @@ public:
         if (t.shape(0) != output.shape(0))
             throw std::runtime_error("t and output must have the same length");
 
-        // Directly call the interpolate function
-        this->interpolate_array(
-            reinterpret_cast<const std::complex<T>*>(input.data()),
-            input.shape(0),
+        interpolate_raw(input, in_T, t, reinterpret_cast<std::complex<T>*>(output.data()));
+    }
+
+    // Same, but allocates the output and returns it
+    OwnedArray<T> interpolate_new(
+        const nb::ndarray<std::complex<T>, nb::ndim<1>> &input,
+        const double in_T,
+        const nb::ndarray<double, nb::ndim<1>> &t
+    ){
+        std::complex<T>* data;
+        OwnedArray<T> output = allocate_output<T>(t.shape(0), data);
+        interpolate_raw(input, in_T, t, data);
+        return output;
+    }
+
+    // Uniform output grid t0 + k * dt, with k over the length of output
+    void interpolate_uniform_numpy(
+        const nb::ndarray<std::complex<T>, nb::ndim<1>> &input,
+        const double in_T,
+        const double t0,
+        const double dt,
+        nb::ndarray<std::complex<T>, nb::ndim<1>> &output
+    ){
+        interpolate_uniform_raw(input, in_T, t0, dt, output.shape(0), reinterpret_cast<std::complex<T>*>(output.data()));
+    }
+
+    // Same, but allocates the N outputs and returns them
+    OwnedArray<T> interpolate_uniform_new(
+        const nb::ndarray<std::complex<T>, nb::ndim<1>> &input,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t N
+    ){
+        std::complex<T>* data;
+        OwnedArray<T> output = allocate_output<T>(N, data);
+        interpolate_uniform_raw(input, in_T, t0, dt, N, data);
+        return output;
+    }
+
+    // Multi-channel: rows of input are channels sharing t, rows of output receive their results
+    void interpolate_channels_numpy(
+        const nb::ndarray<std::complex<T>, nb::ndim<2>, nb::c_contig> &input,
+        const double in_T,
+        const nb::ndarray<double, nb::ndim<1>> &t,
+        nb::ndarray<std::complex<T>, nb::ndim<2>, nb::c_contig> &output
+    ){
+        if (input.shape(0) != output.shape(0))
+            throw std::runtime_error("input and output must have the same number of channels");
+        if (t.shape(0) != output.shape(1))
+            throw std::runtime_error("t and output rows must have the same length");
+
+        const size_t channels = input.shape(0);
+        std::vector<const std::complex<T>*> in_rows(channels);
+        std::vector<std::complex<T>*> out_rows(channels);
+        for (size_t c = 0; c < channels; c++)
+        {
+            in_rows[c] = reinterpret_cast<const std::complex<T>*>(input.data()) + c * input.shape(1);
+            out_rows[c] = reinterpret_cast<std::complex<T>*>(output.data()) + c * output.shape(1);
+        }
+
+        nb::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(m_call_mutex);
+        this->interpolate_channels(
+            in_rows.data(),
+            channels,
+            input.shape(1),
             in_T,
             reinterpret_cast<const double*>(t.data()),
             t.shape(0),
-            reinterpret_cast<std::complex<T>*>(output.data())
+            out_rows.data()
         );
     }
 
     // setters and getters, explicitly
     // TODO: find a way to get CRTP polymorphic chaining restored?
-    int get_up_rate() const {return m_up;}
+    int get_up_rate() const {return this->m_up;}
     void set_up_rate(int up) { 
-        m_up = up;
-        printf("m_up is now %d\n", m_up);
+        // Go through the base so the polyphase bank is rebuilt
+        ufl::UpfirLerp<T>::set_up_rate(up);
     }
 
-    int get_threads() const { return m_threads; }
-    void set_threads(int threads) { m_threads = threads; }
+    int get_threads() const { return this->m_threads; }
+    void set_threads(int threads) { ufl::UpfirLerp<T>::set_threads(threads); }
 
     void set_up_taps(const nb::ndarray<T, nb::ndim<1>> &taps)
     {
@@ -49,37 +129,129 @@ public:
             reinterpret_cast<const T*>(taps.data()), taps.shape(0));
     }
 
+    // Counters of the last call as a dict, with the totals at the top level and one dict per thread.
+    // "enabled" says whether they were compiled in (-DPYUFL_ENABLE_STATS=ON); if not, it is the only key
+    nb::dict get_last_stats() const
+    {
+        nb::dict stats;
+        if (!this->stats_enabled)
+        {
+            stats["enabled"] = false;
+            return stats;
+        }
+
+        auto to_dict = [](const ufl::ThreadStats& s) {
+            nb::dict d;
+            d["outputs"] = s.outputs;
+            d["skipped"] = s.skipped;
+            d["interrim"] = s.interrim;
+            d["macs"] = s.macs;
+            d["seconds"] = s.seconds;
+            return d;
+        };
 
+        const ufl::CallStats& call = ufl::UpfirLerp<T>::get_last_stats();
+        stats = to_dict(call.total());
+        stats["enabled"] = true;
+        stats["wall_seconds"] = call.seconds;
+        stats["imbalance"] = call.imbalance();
+        nb::list threads;
+        for (auto& thread : call.threads)
+            threads.append(to_dict(thread));
+        stats["threads"] = threads;
+        return stats;
+    }
+
+protected:
+    std::mutex m_call_mutex;
+
+    void interpolate_raw(
+        const nb::ndarray<std::complex<T>, nb::ndim<1>> &input,
+        const double in_T,
+        const nb::ndarray<double, nb::ndim<1>> &t,
+        std::complex<T>* out
+    ){
+        nb::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(m_call_mutex);
+        this->interpolate_array(
+            reinterpret_cast<const std::complex<T>*>(input.data()),
+            input.shape(0),
+            in_T,
+            reinterpret_cast<const double*>(t.data()),
+            t.shape(0),
+            out
+        );
+    }
+
+    void interpolate_uniform_raw(
+        const nb::ndarray<std::complex<T>, nb::ndim<1>> &input,
+        const double in_T,
+        const double t0,
+        const double dt,
+        const size_t N,
+        std::complex<T>* out
+    ){
+        nb::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(m_call_mutex);
+        this->interpolate_uniform_array(
+            reinterpret_cast<const std::complex<T>*>(input.data()),
+            input.shape(0),
+            in_T,
+            t0,
+            dt,
+            N,
+            out
+        );
+    }
 };
 
-NB_MODULE(pyufl, m) {
-    // We specify noconvert() so it doesn't change 32f to 64f
-    nb::class_<Pyufl<double>>(m, "PyuflDouble")
+// Both element types get the same methods; noconvert() everywhere,
+// so float32 data is never silently upcast to float64 or the reverse
+template <typename T>
+void bind_pyufl(nb::module_& m, const char* name)
+{
+    nb::class_<Pyufl<T>>(m, name)
         .def(nb::init<>())
-        .def("set_up_rate", &Pyufl<double>::set_up_rate, "up"_a)
-        .def("get_up_rate", &Pyufl<double>::get_up_rate)
-        .def("set_threads", &Pyufl<double>::set_threads, "threads"_a)
-        .def("get_threads", &Pyufl<double>::get_threads)
-        .def("set_up_taps", &Pyufl<double>::set_up_taps, "taps"_a.noconvert())
-        .def("interpolate_numpy", &Pyufl<double>::interpolate_numpy,
+        .def("set_up_rate", &Pyufl<T>::set_up_rate, "up"_a)
+        .def("get_up_rate", &Pyufl<T>::get_up_rate)
+        .def("set_threads", &Pyufl<T>::set_threads, "threads"_a)
+        .def("get_threads", &Pyufl<T>::get_threads)
+        .def("set_up_taps", &Pyufl<T>::set_up_taps, "taps"_a.noconvert())
+        .def("get_last_stats", &Pyufl<T>::get_last_stats)
+        .def("interpolate_numpy", &Pyufl<T>::interpolate_numpy,
+             "input"_a.noconvert(),
+             "in_T"_a,
+             "t"_a.noconvert(),
+             "output"_a.noconvert()
+        )
+        .def("interpolate_numpy", &Pyufl<T>::interpolate_new,
+             "input"_a.noconvert(),
+             "in_T"_a,
+             "t"_a.noconvert()
+        )
+        .def("interpolate_uniform_numpy", &Pyufl<T>::interpolate_uniform_numpy,
+             "input"_a.noconvert(),
+             "in_T"_a,
+             "t0"_a,
+             "dt"_a,
+             "output"_a.noconvert()
+        )
+        .def("interpolate_uniform_numpy", &Pyufl<T>::interpolate_uniform_new,
+             "input"_a.noconvert(),
+             "in_T"_a,
+             "t0"_a,
+             "dt"_a,
+             "N"_a
+        )
+        .def("interpolate_channels_numpy", &Pyufl<T>::interpolate_channels_numpy,
              "input"_a.noconvert(),
              "in_T"_a,
              "t"_a.noconvert(),
              "output"_a.noconvert()
         );
+}
 
-
-    // nb::class_<Pyufl<float>>(m, "PyuflFloat")
-    //     .def(nb::init<>())
-    //     .def("set_up_rate", &Pyufl<float>::set_up_rate, "up"_a)
-    //     .def("get_up_rate", &Pyufl<float>::get_up_rate)
-    //     .def("set_threads", &Pyufl<float>::set_threads, "threads"_a)
-    //     .def("get_threads", &Pyufl<float>::get_threads)
-    //     .def("set_up_taps", &Pyufl<float>::set_up_taps, "taps"_a)
-    //     .def("interpolate_numpy", &Pyufl<float>::interpolate_numpy,
-    //          "input"_a,
-    //          "in_T"_a,
-    //          "t"_a,
-    //          "output"_a
-    //     );
+NB_MODULE(pyufl, m) {
+    bind_pyufl<double>(m, "PyuflDouble");
+    bind_pyufl<float>(m, "PyuflFloat");
 }
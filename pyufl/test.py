@@ -1,12 +1,8 @@
-from pyufl import PyuflDouble
+from pyufl import PyuflDouble, PyuflFloat
 import numpy as np
 import scipy.signal as sps
 
 
-# # This should fail
-# ftaps = taps.astype(np.float32)
-# ufl.set_up_taps(ftaps)
-
 # Make simple qpsk signal
 qpsk = np.array([1, 1j, -1, -1j], dtype=np.complex128)
 
@@ -47,3 +43,47 @@ ufl.interpolate_numpy(
     t,
     uflout
 )
+
+# Uniform grid, compared against the explicit time vector
+t0, dt = -0.002, 0.0013
+tu = t0 + np.arange(40) * dt
+ref = np.zeros(tu.size, dtype=np.complex128)
+ufl.interpolate_numpy(signal, T, tu, ref)
+uniout = np.zeros_like(ref)
+ufl.interpolate_uniform_numpy(signal, T, t0, dt, uniout)
+print("Uniform grid max error: %g" % np.max(np.abs(uniout - ref)))
+
+# Multi-channel, one row per channel, compared against per-channel calls
+channels = np.vstack([signal, signal * 1j, -signal])
+chout = np.zeros((channels.shape[0], t.size), dtype=np.complex128)
+ufl.interpolate_channels_numpy(channels, T, t, chout)
+for c in range(channels.shape[0]):
+    rowout = np.zeros(t.size, dtype=np.complex128)
+    ufl.interpolate_numpy(channels[c].copy(), T, t, rowout)
+    print("Channel %d max error: %g" % (c, np.max(np.abs(chout[c] - rowout))))
+
+# Counters of the last call, if the extension was built with them
+stats = ufl.get_last_stats()
+if stats["enabled"]:
+    print("Last call: %d outputs, %d skipped, %d interrim samples, imbalance %.2f" %
+          (stats["outputs"], stats["skipped"], stats["interrim"], stats["imbalance"]))
+else:
+    print("Stats not compiled in; rebuild with -DPYUFL_ENABLE_STATS=ON")
+
+# Allocating overloads return a new array instead of filling one
+newout = ufl.interpolate_numpy(signal, T, t)
+print("Allocated output max error: %g" % np.max(np.abs(newout - uflout)))
+newuni = ufl.interpolate_uniform_numpy(signal, T, t0, dt, tu.size)
+print("Allocated uniform max error: %g" % np.max(np.abs(newuni - uniout)))
+
+# Single precision; arrays are never converted, so float64 data is rejected
+uflf = PyuflFloat()
+uflf.set_up_rate(up)
+uflf.set_up_taps(taps.astype(np.float32))
+fout = uflf.interpolate_numpy(signal.astype(np.complex64), T, t)
+print("Float32 output dtype: %s, max error vs double: %g" % (fout.dtype, np.max(np.abs(fout - uflout))))
+try:
+    uflf.set_up_taps(taps)
+    print("float64 taps were accepted by PyuflFloat")
+except TypeError:
+    print("float64 taps rejected by PyuflFloat, as expected")
@@ -174,3 +174,43 @@ TEST_CASE("verification against numpy+scipy", "[upfirlerp],[python]")
         }
     }
 };
+
+TEST_CASE("taps shorter than upsample rate", "[upfirlerp]")
+{
+    // Equivalent to scipy.signal.upfirdn([0.1, 1.0, 0.1], [1, 1j], 4),
+    // which is [0.1, 1, 0.1, 0, 0.1j, 1j, 0.1j, 0, ...];
+    // interrim samples with no input sample under the taps must come out as exactly zero
+    std::vector<double> taps = {0.1, 1.0, 0.1};
+    std::vector<std::complex<double>> input = {
+        {1.0, 0.0},
+        {0.0, 1.0}
+    };
+
+    double T = 0.01;
+    std::vector<double> t = {
+        0.00625, 0.00875, 0.0125
+    };
+    std::vector<std::complex<double>> expected = {
+        {0.05, 0.0},
+        {0.0, 0.05},
+        {0.0, 1.0}
+    };
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_threads(1).set_up_rate(4).set_up_taps(taps);
+
+    std::vector<std::complex<double>> output;
+    upfirlerp.interpolate(input, T, t, output);
+
+    for (int i = 0; i < output.size(); ++i)
+    {
+        REQUIRE_THAT(
+            output[i].real(),
+            Catch::Matchers::WithinAbs(expected[i].real(), 1e-12)
+        );
+        REQUIRE_THAT(
+            output[i].imag(),
+            Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12)
+        );
+    }
+}
@@ -0,0 +1,163 @@
+#include "upfirlerp.h"
+#include "fixed.h"
+#include <vector>
+#include <complex>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+
+// Counts every heap allocation of the process, to check that the real-time paths make none
+// once reserve() has sized the workspaces.
+
+static std::atomic<size_t> g_allocations{0};
+
+// GCC pairs the replaced operators with the builtin ones and warns about free()
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t n)
+{
+    g_allocations++;
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// Allocations made by f
+template <typename F>
+static size_t allocations(F&& f)
+{
+    const size_t before = g_allocations;
+    f();
+    return g_allocations - before;
+}
+
+static std::vector<std::complex<float>> make_input(size_t len)
+{
+    std::vector<std::complex<float>> input(len);
+    for (auto& v : input)
+        v = std::complex<float>(std::rand() / (float)RAND_MAX, std::rand() / (float)RAND_MAX);
+    return input;
+}
+
+TEST_CASE("reserved calls do not allocate", "[allocations]")
+{
+    const double T = 1.0;
+    auto input = make_input(2000);
+    const size_t N = 5000;
+
+    std::vector<double> sorted(N), unsorted(N);
+    std::vector<ufl::FixedTime> fixed(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        sorted[i] = i * 0.37;
+        unsorted[i] = std::rand() / (double)RAND_MAX * input.size();
+        fixed[i] = ufl::FixedTime::from_double(sorted[i]);
+    }
+    std::vector<std::complex<float>> out(N);
+
+    // Short filters take the dot products, long ones the overlap-save engine
+    for (int num_taps : {64, 1024})
+    {
+        for (int threads : {1, 3})
+        {
+            ufl::UpfirLerp<float> upfirlerp;
+            upfirlerp.set_up_rate(8).set_up_taps(std::vector<float>(num_taps, 0.01f))
+                .set_threads(threads).reserve(N);
+
+            for (auto strategy : {ufl::Strategy::Auto, ufl::Strategy::PerPoint, ufl::Strategy::Reorder})
+            {
+                upfirlerp.set_strategy(strategy);
+                CHECK(allocations([&]{ upfirlerp.interpolate_array(input.data(), input.size(), T, unsorted.data(), N, out.data()); }) == 0);
+                CHECK(allocations([&]{ upfirlerp.interpolate_array(input.data(), input.size(), T, sorted.data(), N, out.data()); }) == 0);
+            }
+            upfirlerp.set_strategy(ufl::Strategy::Auto);
+
+            CHECK(allocations([&]{ upfirlerp.interpolate_uniform_array(input.data(), input.size(), T, 0.5, 0.37, N, out.data()); }) == 0);
+            CHECK(allocations([&]{ upfirlerp.interpolate_array(input.data(), input.size(), fixed.data(), N, out.data()); }) == 0);
+
+            // The op keeps a dot product, so its forks for several threads are made by the first call and kept
+            ufl::FusedOps<float> op;
+            op.set_gain(2.0f);
+            upfirlerp.interpolate_array(input.data(), input.size(), T, sorted.data(), N, out.data(), op);
+            CHECK(allocations([&]{ upfirlerp.interpolate_array(input.data(), input.size(), T, sorted.data(), N, out.data(), op); }) == 0);
+            CHECK(allocations([&]{ upfirlerp.interpolate_uniform_array(input.data(), input.size(), T, 0.5, 0.37, N, out.data(), op); }) == 0);
+
+            CHECK(allocations([&]{ REQUIRE(upfirlerp.interpolate_into(input, T, sorted, out) == ufl::Status::Ok); }) == 0);
+            CHECK(allocations([&]{ REQUIRE(upfirlerp.interpolate_into(input, fixed, out) == ufl::Status::Ok); }) == 0);
+            CHECK(allocations([&]{ REQUIRE(upfirlerp.interpolate_uniform_into(input, T, 0.5, 0.37, out, op) == ufl::Status::Ok); }) == 0);
+        }
+    }
+}
+
+TEST_CASE("span entry points match the throwing calls and report errors", "[allocations]")
+{
+    const double T = 0.5;
+    auto input = make_input(500);
+    std::vector<double> t(1000);
+    for (size_t i = 0; i < t.size(); i++)
+        t[i] = std::rand() / (double)RAND_MAX * T * input.size();
+
+    ufl::UpfirLerp<float> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(std::vector<float>(33, 0.1f));
+
+    std::vector<std::complex<float>> expected(t.size()), out(t.size());
+    upfirlerp.interpolate_array(input.data(), input.size(), T, t.data(), t.size(), expected.data());
+    REQUIRE(upfirlerp.interpolate_into(input, T, t, out) == ufl::Status::Ok);
+    CHECK(out == expected);
+
+    upfirlerp.interpolate_uniform_array(input.data(), input.size(), T, 1.0, 0.1, t.size(), expected.data());
+    REQUIRE(upfirlerp.interpolate_uniform_into(input, T, 1.0, 0.1, out) == ufl::Status::Ok);
+    CHECK(out == expected);
+
+    // Bad arguments come back as a status, with the output untouched
+    std::fill(out.begin(), out.end(), std::complex<float>(7.0f));
+    std::vector<std::complex<float>> short_out(t.size() - 1);
+    CHECK(upfirlerp.interpolate_into(input, T, t, short_out) == ufl::Status::SizeMismatch);
+    CHECK(upfirlerp.interpolate_into(input, 0.0, t, out) == ufl::Status::InvalidArgument);
+    CHECK(upfirlerp.interpolate_uniform_into(input, T, 0.0, -0.1, out) == ufl::Status::InvalidArgument);
+    CHECK(upfirlerp.interpolate_into(ufl::Span<const std::complex<float>>(), T, t, out) == ufl::Status::Ok);
+    CHECK(out == std::vector<std::complex<float>>(t.size(), std::complex<float>(7.0f)));
+}
+
+TEST_CASE("moved taps match copied ones", "[allocations]")
+{
+    std::vector<float> taps(41);
+    for (size_t i = 0; i < taps.size(); i++)
+        taps[i] = std::rand() / (float)RAND_MAX;
+
+    const double T = 1.0;
+    auto input = make_input(300);
+    std::vector<double> t(500);
+    for (size_t i = 0; i < t.size(); i++)
+        t[i] = i * 0.55;
+
+    ufl::UpfirLerp<float> copied, moved;
+    copied.set_up_rate(4).set_up_taps(taps);
+    moved.set_up_rate(4).set_up_taps(std::vector<float>(taps));
+    CHECK(moved.get_tap_symmetry() == copied.get_tap_symmetry());
+
+    std::vector<std::complex<float>> expected, out;
+    copied.interpolate(input, T, t, expected);
+    moved.interpolate(input, T, t, out);
+    CHECK(out == expected);
+
+    ufl::UpfirLerpFixed<float, 41, 4> fixed_moved;
+    fixed_moved.set_up_taps(std::vector<float>(taps));
+    fixed_moved.interpolate(input, T, t, out);
+    CHECK(out == expected);
+    CHECK_THROWS_AS(fixed_moved.set_up_taps(std::vector<float>(40)), std::invalid_argument);
+}
@@ -0,0 +1,1359 @@
+#include "upfirlerp.h"
+#include "streaming.h"
+#include "fixed.h"
+#include "async.h"
+#include <vector>
+#include <complex>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+// These check the optimised paths against the plain scalar ones,
+// on random data with lengths that exercise every vector remainder.
+
+template <typename T>
+static std::vector<std::complex<T>> random_input(size_t len)
+{
+    std::vector<std::complex<T>> input(len);
+    for (auto& v : input)
+        v = std::complex<T>(std::rand() / (T)RAND_MAX - 0.5, std::rand() / (T)RAND_MAX - 0.5);
+    return input;
+}
+
+// Full-range integer IQ
+template <typename T>
+static std::vector<std::complex<T>> random_iq(size_t len)
+{
+    std::vector<std::complex<T>> input(len);
+    for (auto& v : input)
+        v = std::complex<T>(static_cast<T>(std::rand()), static_cast<T>(std::rand()));
+    return input;
+}
+
+template <typename T>
+static std::vector<T> random_taps(size_t len)
+{
+    std::vector<T> taps(len);
+    for (auto& v : taps)
+        v = std::rand() / (T)RAND_MAX - 0.5;
+    return taps;
+}
+
+TEST_CASE("simd dot kernels match scalar", "[simd]")
+{
+    const ufl::simd::Isa isas[] = {
+        ufl::simd::Isa::Avx2, ufl::simd::Isa::Avx512, ufl::simd::Isa::Neon
+    };
+
+    SECTION("double")
+    {
+        for (size_t n = 0; n < 70; n++)
+        {
+            auto taps = random_taps<double>(n);
+            auto input = random_input<double>(n);
+            std::complex<double> expected = ufl::simd::dot_scalar(taps.data(), input.data(), n);
+
+            for (auto isa : isas)
+            {
+                if (!ufl::simd::isa_supported(isa))
+                    continue;
+
+                std::complex<double> result = ufl::simd::Kernels<double>::dot(isa)(taps.data(), input.data(), n);
+                REQUIRE_THAT(result.real(), Catch::Matchers::WithinAbs(expected.real(), 1e-12));
+                REQUIRE_THAT(result.imag(), Catch::Matchers::WithinAbs(expected.imag(), 1e-12));
+            }
+        }
+    }
+
+    SECTION("float")
+    {
+        for (size_t n = 0; n < 70; n++)
+        {
+            auto taps = random_taps<float>(n);
+            auto input = random_input<float>(n);
+            std::complex<float> expected = ufl::simd::dot_scalar(taps.data(), input.data(), n);
+
+            for (auto isa : isas)
+            {
+                if (!ufl::simd::isa_supported(isa))
+                    continue;
+
+                std::complex<float> result = ufl::simd::Kernels<float>::dot(isa)(taps.data(), input.data(), n);
+                REQUIRE_THAT(result.real(), Catch::Matchers::WithinAbs(expected.real(), 1e-5));
+                REQUIRE_THAT(result.imag(), Catch::Matchers::WithinAbs(expected.imag(), 1e-5));
+            }
+        }
+    }
+
+    SECTION("int16 and int8 input")
+    {
+        for (size_t n = 0; n < 70; n++)
+        {
+            auto taps = random_taps<float>(n);
+            auto input16 = random_iq<int16_t>(n);
+            auto input8 = random_iq<int8_t>(n);
+            std::complex<float> expected16 = ufl::simd::dot_scalar(taps.data(), input16.data(), n);
+            std::complex<float> expected8 = ufl::simd::dot_scalar(taps.data(), input8.data(), n);
+
+            for (auto isa : isas)
+            {
+                if (!ufl::simd::isa_supported(isa))
+                    continue;
+
+                std::complex<float> result16 = ufl::simd::Kernels<float, int16_t>::dot(isa)(taps.data(), input16.data(), n);
+                REQUIRE_THAT(result16.real(), Catch::Matchers::WithinRel(expected16.real(), 1e-5f) || Catch::Matchers::WithinAbs(expected16.real(), 1e-2));
+                REQUIRE_THAT(result16.imag(), Catch::Matchers::WithinRel(expected16.imag(), 1e-5f) || Catch::Matchers::WithinAbs(expected16.imag(), 1e-2));
+
+                std::complex<float> result8 = ufl::simd::Kernels<float, int8_t>::dot(isa)(taps.data(), input8.data(), n);
+                REQUIRE_THAT(result8.real(), Catch::Matchers::WithinAbs(expected8.real(), 1e-3));
+                REQUIRE_THAT(result8.imag(), Catch::Matchers::WithinAbs(expected8.imag(), 1e-3));
+            }
+        }
+    }
+}
+
+// Taps with taps[k] == sign * taps[n - 1 - k]
+template <typename T>
+static std::vector<T> mirrored_taps(size_t len, T sign)
+{
+    std::vector<T> taps = random_taps<T>(len);
+    for (size_t k = 0; k < len / 2; k++)
+        taps[len - 1 - k] = sign * taps[k];
+    if (sign < 0 && len % 2)
+        taps[len / 2] = 0;
+    return taps;
+}
+
+TEST_CASE("simd fold kernels match the plain dot", "[simd],[symmetry]")
+{
+    const ufl::simd::Isa isas[] = {
+        ufl::simd::Isa::Scalar, ufl::simd::Isa::Avx2, ufl::simd::Isa::Avx512, ufl::simd::Isa::Neon
+    };
+
+    for (size_t n = 0; n < 70; n++)
+    {
+        for (int sign : {1, -1})
+        {
+            auto taps = mirrored_taps<double>(n, sign);
+            auto input = random_input<double>(n);
+            std::complex<double> expected = ufl::simd::dot_scalar(taps.data(), input.data(), n);
+
+            auto ftaps = mirrored_taps<float>(n, static_cast<float>(sign));
+            auto finput = random_input<float>(n);
+            auto input16 = random_iq<int16_t>(n);
+            std::complex<float> fexpected = ufl::simd::dot_scalar(ftaps.data(), finput.data(), n);
+            std::complex<float> expected16 = ufl::simd::dot_scalar(ftaps.data(), input16.data(), n);
+
+            for (auto isa : isas)
+            {
+                if (!ufl::simd::isa_supported(isa))
+                    continue;
+
+                std::complex<double> result = ufl::simd::Kernels<double>::fold(isa)(taps.data(), input.data(), n, sign);
+                REQUIRE_THAT(result.real(), Catch::Matchers::WithinAbs(expected.real(), 1e-12));
+                REQUIRE_THAT(result.imag(), Catch::Matchers::WithinAbs(expected.imag(), 1e-12));
+
+                std::complex<float> fresult = ufl::simd::Kernels<float>::fold(isa)(ftaps.data(), finput.data(), n, sign);
+                REQUIRE_THAT(fresult.real(), Catch::Matchers::WithinAbs(fexpected.real(), 1e-5));
+                REQUIRE_THAT(fresult.imag(), Catch::Matchers::WithinAbs(fexpected.imag(), 1e-5));
+
+                std::complex<float> result16 = ufl::simd::Kernels<float, int16_t>::fold(isa)(ftaps.data(), input16.data(), n, sign);
+                REQUIRE_THAT(result16.real(), Catch::Matchers::WithinRel(expected16.real(), 1e-5f) || Catch::Matchers::WithinAbs(expected16.real(), 1e-2));
+                REQUIRE_THAT(result16.imag(), Catch::Matchers::WithinRel(expected16.imag(), 1e-5f) || Catch::Matchers::WithinAbs(expected16.imag(), 1e-2));
+            }
+        }
+    }
+}
+
+TEST_CASE("integer IQ input matches converted float input", "[interpolate],[iq]")
+{
+    auto taps = random_taps<float>(50);
+    auto input = random_iq<int16_t>(1000);
+    const float scale = 1.0f / 32768;
+    double T = 0.01;
+
+    // The same samples, converted up front the way callers had to before
+    std::vector<std::complex<float>> converted(input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+        converted[i] = std::complex<float>(input[i].real(), input[i].imag());
+
+    std::vector<double> t(3000);
+    for (auto& v : t)
+        v = (std::rand() / (double)RAND_MAX * 1.02 - 0.01) * T * input.size();
+
+    ufl::UpfirLerp<float> reference;
+    reference.set_up_rate(4).set_up_taps(taps).set_input_scale(scale);
+    std::vector<std::complex<float>> expected;
+    reference.interpolate(converted, T, t, expected);
+
+    ufl::UpfirLerp<float, int16_t> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(taps).set_input_scale(scale);
+    for (int threads : {1, 3})
+    {
+        upfirlerp.set_threads(threads);
+        std::vector<std::complex<float>> output;
+        upfirlerp.interpolate(input, T, t, output);
+
+        for (int i = 0; i < output.size(); ++i)
+        {
+            REQUIRE_THAT(output[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-5));
+            REQUIRE_THAT(output[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-5));
+        }
+    }
+
+    // Interleaved channels go through the flat accumulation path instead of the dot kernels
+    std::vector<std::complex<int16_t>> interleaved(2 * input.size());
+    std::vector<std::complex<float>> converted2(2 * input.size());
+    for (size_t i = 0; i < interleaved.size(); ++i)
+    {
+        interleaved[i] = input[i / 2];
+        converted2[i] = converted[i / 2];
+    }
+    std::vector<std::complex<float>> out_ref(2 * t.size()), out(2 * t.size());
+    reference.interpolate_interleaved(converted2.data(), 2, input.size(), T, t.data(), t.size(), out_ref.data());
+    upfirlerp.interpolate_interleaved(interleaved.data(), 2, input.size(), T, t.data(), t.size(), out.data());
+    for (int i = 0; i < out.size(); ++i)
+        REQUIRE(out[i] == out_ref[i]);
+}
+
+TEST_CASE("simd interpolation matches scalar interpolation", "[simd],[interpolate]")
+{
+    auto taps = random_taps<double>(129);
+    auto input = random_input<double>(500);
+
+    double T = 0.01;
+    std::vector<double> t(1000);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = std::rand() / (double)RAND_MAX * T * input.size();
+
+    ufl::UpfirLerp<double> scalar;
+    scalar.set_up_rate(8).set_up_taps(taps).set_isa(ufl::simd::Isa::Scalar);
+    std::vector<std::complex<double>> expected;
+    scalar.interpolate(input, T, t, expected);
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(8).set_up_taps(taps).set_threads(2);
+    std::vector<std::complex<double>> output;
+    upfirlerp.interpolate(input, T, t, output);
+
+    for (int i = 0; i < output.size(); ++i)
+    {
+        REQUIRE_THAT(output[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-12));
+        REQUIRE_THAT(output[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12));
+    }
+}
+
+TEST_CASE("invalid up rates are rejected", "[interpolate]")
+{
+    ufl::UpfirLerp<double> upfirlerp;
+    REQUIRE_THROWS_AS(upfirlerp.set_up_rate(0), std::invalid_argument);
+
+    upfirlerp.set_up_rate(4).set_up_taps(random_taps<double>(33));
+    REQUIRE_THROWS_AS(upfirlerp.set_up_rate(-2), std::invalid_argument);
+    REQUIRE(upfirlerp.get_up_rate() == 4);
+}
+
+TEST_CASE("sorted time fast path matches per-point evaluation", "[interpolate],[sorted]")
+{
+    auto taps = random_taps<double>(64);
+    auto input = random_input<double>(200);
+
+    // Dense and sorted, with out-of-range samples at both ends
+    double T = 0.01;
+    std::vector<double> t(3000);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = -0.1 + i * T / 12;
+
+    ufl::UpfirLerp<double> unsorted;
+    unsorted.set_up_rate(8).set_up_taps(taps).set_time_order(ufl::TimeOrder::Unsorted);
+    std::vector<std::complex<double>> expected;
+    unsorted.interpolate(input, T, t, expected);
+
+    for (int threads = 1; threads <= 3; threads++)
+    {
+        ufl::UpfirLerp<double> sorted;
+        sorted.set_up_rate(8).set_up_taps(taps).set_threads(threads);
+        std::vector<std::complex<double>> output;
+        sorted.interpolate(input, T, t, output);
+
+        // The same interrim samples are computed either way, just fewer times
+        for (int i = 0; i < output.size(); ++i)
+            REQUIRE(output[i] == expected[i]);
+    }
+}
+
+TEST_CASE("uniform grid matches explicit time vector", "[interpolate],[uniform]")
+{
+    auto taps = random_taps<double>(48);
+    auto input = random_input<double>(300);
+
+    double T = 0.01;
+    // Starts before the input and runs past its end
+    const double t0 = -0.0173;
+    const double dt = T / 7.3;
+    const size_t N = 2500;
+
+    std::vector<double> t(N);
+    for (size_t k = 0; k < N; ++k)
+        t[k] = t0 + k * dt;
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(6).set_up_taps(taps);
+
+    std::vector<std::complex<double>> expected;
+    upfirlerp.interpolate(input, T, t, expected);
+
+    for (int threads = 1; threads <= 3; threads++)
+    {
+        upfirlerp.set_threads(threads);
+        std::vector<std::complex<double>> output;
+        upfirlerp.interpolate_uniform(input, T, t0, dt, N, output);
+
+        REQUIRE(output.size() == N);
+        for (size_t k = 0; k < N; ++k)
+        {
+            REQUIRE_THAT(output[k].real(), Catch::Matchers::WithinAbs(expected[k].real(), 1e-9));
+            REQUIRE_THAT(output[k].imag(), Catch::Matchers::WithinAbs(expected[k].imag(), 1e-9));
+        }
+    }
+}
+
+TEST_CASE("streaming matches a single call over the whole signal", "[streaming]")
+{
+    auto taps = random_taps<double>(77);
+    auto input = random_input<double>(5000);
+
+    double T = 0.01;
+    std::vector<double> t(20000);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = -0.05 + i * T / 3.7;
+
+    ufl::UpfirLerp<double> whole;
+    whole.set_up_rate(5).set_up_taps(taps);
+    std::vector<std::complex<double>> expected(t.size());
+    whole.interpolate_array(input.data(), input.size(), T, t.data(), t.size(), expected.data());
+
+    ufl::StreamUpfirLerp<double> stream;
+    stream.set_up_rate(5).set_up_taps(taps);
+    stream.set_input_period(T);
+
+    std::vector<std::complex<double>> output(t.size());
+    size_t pushed = 0;
+    size_t pulled = 0;
+    while (pushed < input.size())
+    {
+        // Irregular block sizes, including ones shorter than the filter history
+        size_t len = 1 + std::rand() % 300;
+        len = pushed + len > input.size() ? input.size() - pushed : len;
+        stream.push(input.data() + pushed, len);
+        pushed += len;
+
+        pulled += stream.pull(t.data() + pulled, t.size() - pulled, output.data() + pulled);
+
+        // History stays bounded by the filter, not the stream
+        REQUIRE(stream.get_buffered() <= len + taps.size());
+    }
+    stream.finish();
+    pulled += stream.pull(t.data() + pulled, t.size() - pulled, output.data() + pulled);
+
+    REQUIRE(pulled == t.size());
+    for (int i = 0; i < output.size(); ++i)
+        REQUIRE(output[i] == expected[i]);
+}
+
+TEST_CASE("streaming with several pushes between pulls", "[streaming]")
+{
+    auto taps = random_taps<double>(60);
+    auto input = random_input<double>(6000);
+
+    double T = 0.01;
+    std::vector<double> t(15000);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = i * T / 2.5;
+
+    ufl::UpfirLerp<double> whole;
+    whole.set_up_rate(3).set_up_taps(taps);
+    std::vector<std::complex<double>> expected(t.size());
+    whole.interpolate_array(input.data(), input.size(), T, t.data(), t.size(), expected.data());
+
+    ufl::StreamUpfirLerp<double> stream;
+    stream.set_up_rate(3).set_up_taps(taps);
+    stream.set_input_period(T);
+
+    // Bursts of up to 6 short blocks, so the dead history is dropped only every few pushes
+    std::vector<std::complex<double>> output(t.size());
+    size_t pushed = 0;
+    size_t pulled = 0;
+    while (pushed < input.size())
+    {
+        size_t burst = 0;
+        for (int k = 1 + std::rand() % 6; k > 0 && pushed < input.size(); k--)
+        {
+            size_t len = std::min<size_t>(1 + std::rand() % 100, input.size() - pushed);
+            stream.push(input.data() + pushed, len);
+            pushed += len;
+            burst += len;
+        }
+        pulled += stream.pull(t.data() + pulled, t.size() - pulled, output.data() + pulled);
+        REQUIRE(stream.get_buffered() <= burst + taps.size());
+    }
+    stream.finish();
+    pulled += stream.pull(t.data() + pulled, t.size() - pulled, output.data() + pulled);
+
+    REQUIRE(pulled == t.size());
+    for (int i = 0; i < output.size(); ++i)
+        REQUIRE(output[i] == expected[i]);
+}
+
+TEST_CASE("multi-channel batches match per-channel calls", "[interpolate],[channels]")
+{
+    const size_t channels = 5;
+    const size_t in_length = 400;
+    auto taps = random_taps<double>(40);
+
+    std::vector<std::vector<std::complex<double>>> inputs;
+    for (size_t c = 0; c < channels; c++)
+        inputs.push_back(random_input<double>(in_length));
+
+    double T = 0.01;
+    std::vector<double> t(1500);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = (std::rand() / (double)RAND_MAX * 1.2 - 0.1) * T * in_length;
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(taps);
+
+    std::vector<std::vector<std::complex<double>>> expected(channels);
+    for (size_t c = 0; c < channels; c++)
+        upfirlerp.interpolate(inputs[c], T, t, expected[c]);
+
+    for (int threads : {1, 2, 4, 6})
+    {
+        upfirlerp.set_threads(threads);
+
+        SECTION("channel-major, " + std::to_string(threads) + " threads")
+        {
+            std::vector<const std::complex<double>*> in_ptrs;
+            std::vector<std::vector<std::complex<double>>> outputs(channels, std::vector<std::complex<double>>(t.size()));
+            std::vector<std::complex<double>*> out_ptrs;
+            for (size_t c = 0; c < channels; c++)
+            {
+                in_ptrs.push_back(inputs[c].data());
+                out_ptrs.push_back(outputs[c].data());
+            }
+
+            upfirlerp.interpolate_channels(
+                in_ptrs.data(), channels, in_length, T, t.data(), t.size(), out_ptrs.data());
+
+            for (size_t c = 0; c < channels; c++)
+                for (int i = 0; i < t.size(); ++i)
+                    REQUIRE(outputs[c][i] == expected[c][i]);
+        }
+
+        SECTION("interleaved, " + std::to_string(threads) + " threads")
+        {
+            std::vector<std::complex<double>> in_interleaved(in_length * channels);
+            for (size_t k = 0; k < in_length; k++)
+                for (size_t c = 0; c < channels; c++)
+                    in_interleaved[k * channels + c] = inputs[c][k];
+
+            std::vector<std::complex<double>> out_interleaved(t.size() * channels);
+            upfirlerp.interpolate_interleaved(
+                in_interleaved.data(), channels, in_length, T, t.data(), t.size(), out_interleaved.data());
+
+            for (size_t c = 0; c < channels; c++)
+            {
+                for (int i = 0; i < t.size(); ++i)
+                {
+                    REQUIRE_THAT(out_interleaved[i * channels + c].real(), Catch::Matchers::WithinAbs(expected[c][i].real(), 1e-12));
+                    REQUIRE_THAT(out_interleaved[i * channels + c].imag(), Catch::Matchers::WithinAbs(expected[c][i].imag(), 1e-12));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("folded symmetric taps match unfolded taps", "[interpolate],[symmetry]")
+{
+    const size_t in_length = 600;
+    const size_t channels = 3;
+    auto input = random_input<double>(in_length * channels);
+    std::vector<std::complex<double>> first(input.begin(), input.begin() + in_length);
+
+    double T = 0.01;
+    std::vector<double> t(3000);
+    for (auto& v : t)
+        v = (std::rand() / (double)RAND_MAX * 1.2 - 0.1) * T * in_length;
+
+    // Each rate has a length whose self-mirrored sub-filters are long enough to fold
+    for (int up : {1, 2, 3, 4})
+    {
+        for (size_t ntaps : {64, 65, 129, 130})
+        {
+            for (double sign : {1.0, -1.0})
+            {
+                auto taps = mirrored_taps<double>(ntaps, sign);
+
+                ufl::UpfirLerp<double> folded, plain;
+                folded.set_up_rate(up).set_up_taps(taps);
+                REQUIRE(folded.get_tap_symmetry() == (sign > 0 ? ufl::Symmetry::Even : ufl::Symmetry::Odd));
+                plain.set_up_rate(up).set_up_taps(taps, ufl::Symmetry::None);
+                REQUIRE(plain.get_tap_symmetry() == ufl::Symmetry::None);
+
+                std::vector<std::complex<double>> expected, result;
+                plain.interpolate(first, T, t, expected);
+                folded.interpolate(first, T, t, result);
+                for (size_t i = 0; i < t.size(); i++)
+                {
+                    REQUIRE_THAT(result[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-12));
+                    REQUIRE_THAT(result[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12));
+                }
+
+                // The interleaved path folds on its own; channel 0 is the first signal
+                std::vector<std::complex<double>> interleaved(in_length * channels);
+                for (size_t k = 0; k < in_length; k++)
+                    for (size_t c = 0; c < channels; c++)
+                        interleaved[k * channels + c] = c == 0 ? first[k] : input[c * in_length + k];
+                std::vector<std::complex<double>> out_interleaved(t.size() * channels);
+                folded.interpolate_interleaved(interleaved.data(), channels, in_length, T, t.data(), t.size(), out_interleaved.data());
+                for (size_t i = 0; i < t.size(); i++)
+                {
+                    REQUIRE_THAT(out_interleaved[i * channels].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-12));
+                    REQUIRE_THAT(out_interleaved[i * channels].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12));
+                }
+            }
+        }
+    }
+
+    SECTION("random taps are not symmetric")
+    {
+        ufl::UpfirLerp<double> upfirlerp;
+        upfirlerp.set_up_rate(2).set_up_taps(random_taps<double>(65));
+        REQUIRE(upfirlerp.get_tap_symmetry() == ufl::Symmetry::None);
+    }
+
+    SECTION("a declared symmetry mirrors the first half")
+    {
+        auto taps = random_taps<double>(65);
+        auto mirrored = taps;
+        for (size_t k = 0; k < 32; k++)
+            mirrored[64 - k] = -mirrored[k];
+        mirrored[32] = 0;
+
+        ufl::UpfirLerp<double> declared, plain;
+        declared.set_up_rate(2).set_up_taps(taps, ufl::Symmetry::Odd);
+        REQUIRE(declared.get_tap_symmetry() == ufl::Symmetry::Odd);
+        plain.set_up_rate(2).set_up_taps(mirrored, ufl::Symmetry::None);
+
+        std::vector<std::complex<double>> expected, result;
+        plain.interpolate(first, T, t, expected);
+        declared.interpolate(first, T, t, result);
+        for (size_t i = 0; i < t.size(); i++)
+        {
+            REQUIRE_THAT(result[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-12));
+            REQUIRE_THAT(result[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12));
+        }
+    }
+}
+
+TEST_CASE("block engine matches per-point evaluation", "[interpolate],[strategy]")
+{
+    auto taps = random_taps<double>(50);
+    auto input = random_input<double>(2000);
+    double T = 0.01;
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(taps).set_threads(2);
+
+    // Dense and shuffled, so it is unsorted but touches most interrim samples several times
+    std::vector<double> dense(20000);
+    for (int i = 0; i < dense.size(); ++i)
+        dense[i] = (i * 0.98 / dense.size() - 0.01) * T * input.size();
+    for (size_t i = dense.size() - 1; i > 0; i--)
+        std::swap(dense[i], dense[std::rand() % (i + 1)]);
+
+    // A handful of points scattered over the whole input
+    std::vector<double> sparse(20);
+    for (auto& v : sparse)
+        v = std::rand() / (double)RAND_MAX * T * input.size();
+
+    for (auto* t : {&dense, &sparse})
+    {
+        std::vector<std::complex<double>> expected;
+        upfirlerp.set_strategy(ufl::Strategy::PerPoint);
+        upfirlerp.interpolate(input, T, *t, expected);
+
+        std::vector<std::complex<double>> output;
+        upfirlerp.set_strategy(ufl::Strategy::Block);
+        upfirlerp.interpolate(input, T, *t, output);
+        for (auto s : upfirlerp.get_last_strategies())
+            REQUIRE(s == ufl::Strategy::Block);
+
+        for (int i = 0; i < output.size(); ++i)
+            REQUIRE(output[i] == expected[i]);
+
+        // Auto should pick blocks only for the dense pattern
+        upfirlerp.set_strategy(ufl::Strategy::Auto);
+        upfirlerp.interpolate(input, T, *t, output);
+        for (auto s : upfirlerp.get_last_strategies())
+            REQUIRE(s == (t == &dense ? ufl::Strategy::Block : ufl::Strategy::PerPoint));
+    }
+}
+
+TEST_CASE("reordered evaluation matches per-point evaluation", "[interpolate],[strategy],[reorder]")
+{
+    auto taps = random_taps<double>(50);
+    auto input = random_input<double>(5000);
+    double T = 0.01;
+
+    // Shuffled, with some of it past both ends and repeated times
+    std::vector<double> t(30000);
+    for (auto& v : t)
+        v = (std::rand() / (double)RAND_MAX * 1.1 - 0.05) * T * input.size();
+    for (size_t i = 0; i < 1000; i++)
+        t[std::rand() % t.size()] = t[i];
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(taps);
+
+    std::vector<std::complex<double>> expected;
+    upfirlerp.set_strategy(ufl::Strategy::PerPoint);
+    upfirlerp.interpolate(input, T, t, expected);
+
+    for (int threads : {1, 3})
+    {
+        upfirlerp.set_threads(threads).set_strategy(ufl::Strategy::Reorder);
+
+        std::vector<std::complex<double>> output;
+        upfirlerp.interpolate(input, T, t, output);
+        for (auto s : upfirlerp.get_last_strategies())
+            REQUIRE(s == ufl::Strategy::Reorder);
+        for (size_t i = 0; i < t.size(); ++i)
+            REQUIRE(output[i] == expected[i]);
+
+        // An epilogue sees the outputs in order, as with any other strategy
+        std::vector<std::complex<double>> ref = random_input<double>(t.size());
+        ufl::FusedOps<double> ops;
+        ops.set_gain(2).set_reference(ref.data());
+        upfirlerp.interpolate(input, T, t, output, ops);
+
+        std::complex<double> dot = 0;
+        for (size_t i = 0; i < t.size(); ++i)
+        {
+            REQUIRE(output[i] == expected[i] * 2.0);
+            dot += std::conj(ref[i]) * expected[i] * 2.0;
+        }
+        REQUIRE_THAT(ops.get_dot().real(), Catch::Matchers::WithinAbs(dot.real(), 1e-9));
+        REQUIRE_THAT(ops.get_dot().imag(), Catch::Matchers::WithinAbs(dot.imag(), 1e-9));
+    }
+
+    SECTION("sorted times stay per-point")
+    {
+        std::sort(t.begin(), t.end());
+        upfirlerp.set_strategy(ufl::Strategy::Reorder).set_schedule(ufl::Schedule::Static);
+        std::vector<std::complex<double>> output;
+        upfirlerp.interpolate(input, T, t, output);
+        for (auto s : upfirlerp.get_last_strategies())
+            REQUIRE(s == ufl::Strategy::PerPoint);
+    }
+
+    SECTION("radix sort is stable on the sorted bits")
+    {
+        // Sizes with one bucket and with many, and odd and even numbers of passes per bucket
+        for (size_t n : {5000, 300000})
+        {
+            for (int hi : {40, 30})
+            {
+                std::vector<uint64_t> keys(n), spare;
+                for (auto& k : keys)
+                    k = (static_cast<uint64_t>(std::rand()) << 20) ^ static_cast<uint64_t>(std::rand());
+                auto expected_keys = keys;
+                // Bits [3, hi) only, so keys equal there keep their input order
+                const uint64_t mask = (uint64_t(1) << (hi - 3)) - 1;
+                std::stable_sort(expected_keys.begin(), expected_keys.end(), [mask](uint64_t a, uint64_t b){
+                    return ((a >> 3) & mask) < ((b >> 3) & mask);
+                });
+                ufl::detail::radix_sort(keys, spare, 3, hi);
+                REQUIRE(keys == expected_keys);
+            }
+        }
+    }
+}
+
+TEST_CASE("fixed specialisations match the generic path", "[interpolate],[fixed]")
+{
+    auto taps = random_taps<double>(64);
+    auto input = random_input<double>(1000);
+    double T = 0.01;
+
+    // Unsorted, and reaching past both ends so the edge fallback is used too
+    std::vector<double> t(5000);
+    for (auto& v : t)
+        v = (std::rand() / (double)RAND_MAX * 1.02 - 0.01) * T * input.size();
+
+    ufl::UpfirLerp<double> generic;
+    generic.set_up_rate(8).set_up_taps(taps).set_isa(ufl::simd::Isa::Scalar);
+    std::vector<std::complex<double>> expected;
+    generic.interpolate(input, T, t, expected);
+
+    ufl::UpfirLerpFixed<double, 64, 8> fixed;
+    fixed.set_up_taps(taps);
+    std::vector<std::complex<double>> output;
+    fixed.interpolate(input, T, t, output);
+    for (int i = 0; i < output.size(); ++i)
+    {
+        REQUIRE_THAT(output[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-12));
+        REQUIRE_THAT(output[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12));
+    }
+
+    REQUIRE_THROWS_AS(fixed.set_up_taps(random_taps<double>(63)), std::invalid_argument);
+    REQUIRE_THROWS_AS(fixed.set_up_rate(4), std::invalid_argument);
+
+    SECTION("registry")
+    {
+        auto resampler = ufl::make_upfirlerp<double>(taps, 8);
+        REQUIRE(resampler->is_fixed());
+        resampler->interpolate(input, T, t, output);
+        for (int i = 0; i < output.size(); ++i)
+        {
+            REQUIRE_THAT(output[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-12));
+            REQUIRE_THAT(output[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-12));
+        }
+
+        // Anything not registered goes to the generic class
+        REQUIRE_FALSE(ufl::make_upfirlerp<double>(taps, 4)->is_fixed());
+        REQUIRE_FALSE(ufl::make_upfirlerp<double>(random_taps<double>(50), 8)->is_fixed());
+    }
+}
+
+TEST_CASE("dynamic scheduling matches the static split", "[interpolate],[schedule]")
+{
+    auto taps = random_taps<double>(40);
+    auto input = random_input<double>(3000);
+    double T = 0.01;
+
+    // Sorted and clustered, reaching past both ends
+    std::vector<double> sorted(20000);
+    for (int i = 0; i < sorted.size(); ++i)
+    {
+        double x = i / (double)sorted.size();
+        sorted[i] = (x * x * x * 1.2 - 0.1) * T * input.size();
+    }
+    // Unsorted, with the first half out of range
+    std::vector<double> skewed(20000);
+    for (int i = 0; i < skewed.size(); ++i)
+        skewed[i] = (i < skewed.size() / 2 ? -1.0 : std::rand() / (double)RAND_MAX) * T * input.size();
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(5).set_up_taps(taps).set_strategy(ufl::Strategy::PerPoint);
+
+    for (auto* t : {&sorted, &skewed})
+    {
+        std::vector<std::complex<double>> expected;
+        upfirlerp.set_threads(1).set_schedule(ufl::Schedule::Static);
+        upfirlerp.interpolate(input, T, *t, expected);
+
+        for (int threads : {2, 3, 4})
+        {
+            for (size_t grain : {0, 1, 100, 5000})
+            {
+                std::vector<std::complex<double>> output;
+                upfirlerp.set_threads(threads).set_schedule(ufl::Schedule::Dynamic, grain);
+                upfirlerp.interpolate(input, T, *t, output);
+
+                for (int i = 0; i < output.size(); ++i)
+                    REQUIRE(output[i] == expected[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("multi-hypothesis offsets match one call per hypothesis", "[interpolate],[hypotheses]")
+{
+    auto taps = random_taps<double>(48);
+    auto input = random_input<double>(4000);
+    double T = 0.01;
+
+    // Sorted and reaching past both ends, so the shared buffer is used;
+    // and unsorted over the whole signal, so the output-by-output walk is
+    std::vector<double> sorted(5000);
+    for (int i = 0; i < sorted.size(); ++i)
+        sorted[i] = (i / (double)sorted.size() * 1.1 - 0.05) * T * input.size();
+    std::vector<double> unsorted(5000);
+    for (auto& v : unsorted)
+        v = std::rand() / (double)RAND_MAX * T * input.size();
+
+    // Smaller and larger than an interrim sample, and one that moves everything out of range
+    std::vector<double> offsets = {-0.3 * T, -0.001 * T, 0.0, 0.0004 * T, 0.05 * T, 2.7 * T, -1000 * T};
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(6).set_up_taps(taps);
+
+    for (auto* t : {&sorted, &unsorted})
+    {
+        for (int threads : {1, 3})
+        {
+            upfirlerp.set_threads(threads);
+
+            std::vector<std::complex<double>> output;
+            upfirlerp.interpolate_offsets(input, T, *t, offsets, output);
+            REQUIRE(output.size() == offsets.size() * t->size());
+
+            // The same times as a matrix
+            std::vector<double> tm(offsets.size() * t->size());
+            for (size_t k = 0; k < offsets.size(); k++)
+                for (size_t i = 0; i < t->size(); i++)
+                    tm[k * t->size() + i] = (*t)[i] + offsets[k];
+            std::vector<std::complex<double>> matrix(tm.size());
+            upfirlerp.interpolate_matrix(input.data(), input.size(), T, tm.data(), offsets.size(), t->size(), matrix.data());
+
+            for (size_t k = 0; k < offsets.size(); k++)
+            {
+                std::vector<double> tk(tm.begin() + k * t->size(), tm.begin() + (k + 1) * t->size());
+                std::vector<std::complex<double>> expected;
+                upfirlerp.interpolate(input, T, tk, expected);
+
+                for (size_t i = 0; i < t->size(); i++)
+                {
+                    REQUIRE(output[k * t->size() + i] == expected[i]);
+                    REQUIRE(matrix[k * t->size() + i] == expected[i]);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("interrim cache matches uncached calls", "[interpolate],[cache]")
+{
+    auto taps = random_taps<double>(36);
+    auto input = random_input<double>(5000);
+    double T = 0.01;
+
+    // A few clusters of times, as a timing search would visit them, reaching past both ends
+    std::vector<double> t(3000);
+    for (int i = 0; i < t.size(); ++i)
+        t[i] = ((i % 3) * 0.4 - 0.05 + (i / 3) * 1e-4) * T * input.size();
+
+    ufl::UpfirLerp<double> plain;
+    plain.set_up_rate(8).set_up_taps(taps);
+    ufl::UpfirLerp<double> cached;
+    cached.set_up_rate(8).set_up_taps(taps).set_interrim_cache(64);
+
+    auto check = [&](const std::vector<double>& times){
+        std::vector<std::complex<double>> expected(times.size()), output(times.size());
+        plain.interpolate(input, T, times, expected);
+        cached.interpolate(input, T, times, output);
+        for (size_t i = 0; i < times.size(); ++i)
+            REQUIRE(output[i] == expected[i]);
+    };
+
+    for (int threads : {1, 3})
+    {
+        cached.set_threads(threads).set_interrim_cache(64);
+
+        size_t valid = 0;
+        for (double v : t)
+            valid += v >= 0 && v <= T / 8 * (input.size() * 8 - 1);
+
+        // Every output reads two samples, each a hit or a miss
+        check(t);
+        const ufl::CacheStats first = cached.get_cache_stats();
+        REQUIRE(first.misses > 0);
+        REQUIRE(first.hits == 2 * valid - first.misses);
+
+        // The same times again only hit
+        check(t);
+        REQUIRE(cached.get_cache_stats().misses == first.misses);
+        REQUIRE(cached.get_cache_stats().hits == first.hits + 2 * valid);
+
+        // Slightly moved times need few new samples
+        std::vector<double> moved(t);
+        for (auto& v : moved)
+            v += 0.3 * T / 8;
+        check(moved);
+        const size_t moved_misses = cached.get_cache_stats().misses - first.misses;
+        REQUIRE(moved_misses > 0);
+        REQUIRE(moved_misses < first.misses / 2);
+
+        // In-place input changes need an explicit invalidation
+        for (auto& v : input)
+            v *= 0.5;
+        const size_t before = cached.get_cache_stats().misses;
+        cached.invalidate_interrim_cache();
+        check(moved);
+        REQUIRE(cached.get_cache_stats().misses - before > first.misses / 2);
+
+        // New taps drop the samples by themselves
+        taps = random_taps<double>(36);
+        plain.set_up_taps(taps);
+        cached.set_up_taps(taps);
+        check(t);
+
+        // Times spread over the whole input need more tiles than the cache holds
+        std::vector<double> spread(4000);
+        for (auto& v : spread)
+            v = std::rand() / (double)RAND_MAX * T * input.size();
+        check(spread);
+        REQUIRE(cached.get_cache_stats().bypassed == 1);
+
+        // A single tile, alternately needed by two sets of times, is evicted each time
+        cached.set_interrim_cache(1);
+        std::vector<double> a(50), b(50);
+        for (int i = 0; i < a.size(); ++i)
+        {
+            a[i] = (10 + i * 1.7) * T / 8;
+            b[i] = a[i] + 2048 * T / 8;
+        }
+        check(a);
+        check(b);
+        check(a);
+        REQUIRE(cached.get_cache_stats().evictions == 2);
+        REQUIRE(cached.get_cache_stats().bypassed == 0);
+    }
+}
+
+TEST_CASE("fixed-point times match double times", "[interpolate],[fixedtime]")
+{
+    auto taps = random_taps<double>(40);
+    auto input = random_input<double>(700);
+    double T = 0.01;
+
+    // Unsorted, and reaching past both ends
+    std::vector<double> t(2000);
+    for (auto& v : t)
+        v = (std::rand() / (double)RAND_MAX * 1.04 - 0.02) * T * input.size();
+    t[0] = 0;
+    t[1] = T / 5 * (input.size() * 5 - 1);
+
+    std::vector<ufl::FixedTime> positions(t.size());
+    for (size_t i = 0; i < t.size(); ++i)
+        positions[i] = ufl::FixedTime::from_double(t[i] / T);
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(5).set_up_taps(taps);
+    std::vector<std::complex<double>> expected;
+    upfirlerp.interpolate(input, T, t, expected);
+
+    for (int threads : {1, 3})
+    {
+        upfirlerp.set_threads(threads);
+        // Outputs outside the signal are left untouched
+        std::vector<std::complex<double>> output(t.size(), std::complex<double>(7, 7));
+        upfirlerp.interpolate_array(input.data(), input.size(), positions.data(), positions.size(), output.data());
+
+        for (size_t i = 0; i < t.size(); ++i)
+        {
+            const bool valid = t[i] >= 0 && t[i] <= T / 5 * (input.size() * 5 - 1);
+            if (!valid)
+            {
+                REQUIRE(output[i] == std::complex<double>(7, 7));
+                continue;
+            }
+            REQUIRE_THAT(output[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-9));
+            REQUIRE_THAT(output[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-9));
+        }
+    }
+}
+
+TEST_CASE("interrim indices past 2^31 match a window of the input", "[interpolate],[fixedtime]")
+{
+    // 3M samples upsampled by 1024 is over 3 * 10^9 interrim samples
+    const int up = 1024;
+    auto taps = random_taps<float>(4 * up);
+    std::vector<std::complex<int8_t>> input(3000000);
+    const size_t W = 2000;
+    const size_t offset = input.size() - W;
+    auto tail = random_iq<int8_t>(W);
+    std::copy(tail.begin(), tail.end(), input.begin() + offset);
+    double T = 0.01;
+
+    // Near the end of the signal, and one past it
+    std::vector<ufl::FixedTime> positions(500), shifted(500);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        positions[i] = ufl::FixedTime::from_double(input.size() - 1500 + i * 2.9 + std::rand() / (double)RAND_MAX);
+        shifted[i] = positions[i];
+        shifted[i].whole -= offset;
+    }
+    positions.back().whole = input.size();
+    shifted.back().whole = W;
+    REQUIRE(positions[0].whole * up > std::numeric_limits<int32_t>::max());
+
+    ufl::UpfirLerp<float, int8_t> upfirlerp;
+    upfirlerp.set_up_rate(up).set_up_taps(taps).set_input_scale(1.0f / 128);
+
+    std::vector<std::complex<float>> expected(positions.size());
+    upfirlerp.interpolate_array(input.data() + offset, W, shifted.data(), shifted.size(), expected.data());
+    REQUIRE(std::abs(expected[0]) > 0);
+
+    for (int threads : {1, 3})
+    {
+        upfirlerp.set_threads(threads);
+        std::vector<std::complex<float>> output(positions.size());
+        upfirlerp.interpolate_array(input.data(), input.size(), positions.data(), positions.size(), output.data());
+        for (size_t i = 0; i < positions.size(); ++i)
+            REQUIRE(output[i] == expected[i]);
+
+        // Double times take the same index path, to the precision a double has at this range
+        std::vector<double> t(positions.size() - 1), t_shifted(positions.size() - 1);
+        for (size_t i = 0; i < t.size(); ++i)
+        {
+            t[i] = (positions[i].whole + positions[i].fraction()) * T;
+            t_shifted[i] = (shifted[i].whole + shifted[i].fraction()) * T;
+        }
+        std::vector<std::complex<float>> from_doubles(t.size()), from_window(t.size());
+        upfirlerp.interpolate_array(input.data(), input.size(), T, t.data(), t.size(), from_doubles.data());
+        upfirlerp.interpolate_array(input.data() + offset, W, T, t_shifted.data(), t_shifted.size(), from_window.data());
+        for (size_t i = 0; i < t.size(); ++i)
+        {
+            REQUIRE_THAT(from_doubles[i].real(), Catch::Matchers::WithinAbs(from_window[i].real(), 1e-3));
+            REQUIRE_THAT(from_doubles[i].imag(), Catch::Matchers::WithinAbs(from_window[i].imag(), 1e-3));
+        }
+    }
+}
+
+TEST_CASE("fused epilogue matches a separate pass over the output", "[interpolate],[epilogue]")
+{
+    auto taps = random_taps<double>(60);
+    auto input = random_input<double>(4000);
+    double T = 0.01;
+    const double freq = 3.7, phase = 0.4, gain = 1.5;
+
+    auto mixed = [&](const std::complex<double>& y, double t){
+        return gain * y * std::polar(1.0, 2 * 3.141592653589793 * freq * t + phase);
+    };
+    auto check = [](const std::complex<double>& a, const std::complex<double>& b){
+        REQUIRE_THAT(a.real(), Catch::Matchers::WithinAbs(b.real(), 1e-9));
+        REQUIRE_THAT(a.imag(), Catch::Matchers::WithinAbs(b.imag(), 1e-9));
+    };
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(6).set_up_taps(taps);
+
+    // Sorted and unsorted times, reaching past both ends; the unsorted ones also go through the block engine
+    std::vector<double> sorted_t(9000), unsorted_t(9000);
+    for (size_t i = 0; i < sorted_t.size(); ++i)
+    {
+        sorted_t[i] = (i / (double)sorted_t.size() * 1.04 - 0.02) * T * input.size();
+        unsorted_t[i] = (std::rand() / (double)RAND_MAX * 1.04 - 0.02) * T * input.size();
+    }
+    auto reference = random_input<double>(9000);
+
+    for (int threads : {1, 3})
+    {
+        upfirlerp.set_threads(threads);
+        for (int cached : {0, 1})
+        {
+            upfirlerp.set_interrim_cache(cached ? 256 : 0);
+            for (const auto& t : {sorted_t, unsorted_t})
+            {
+                std::vector<std::complex<double>> plain;
+                upfirlerp.interpolate(input, T, t, plain);
+
+                // Accumulates onto existing contents, which outputs outside the signal keep
+                std::vector<std::complex<double>> out(t.size(), std::complex<double>(1, -1));
+                ufl::FusedOps<double> ops;
+                ops.set_gain(gain).set_mixer(freq, phase).set_accumulate(true).set_reference(reference.data());
+                upfirlerp.interpolate(input, T, t, out, ops);
+
+                std::complex<double> dot = 0;
+                for (size_t i = 0; i < t.size(); ++i)
+                {
+                    const bool valid = t[i] >= 0 && t[i] <= T / 6 * (input.size() * 6 - 1);
+                    const std::complex<double> v = valid ? mixed(plain[i], t[i]) : 0;
+                    check(out[i], std::complex<double>(1, -1) + v);
+                    dot += std::conj(reference[i]) * v;
+                }
+                check(ops.get_dot(), dot);
+            }
+        }
+    }
+
+    // On a uniform grid the mixer steps a recurrence across several resyncs
+    upfirlerp.set_interrim_cache(0);
+    const double t0 = -0.013, dt = T / 2.3;
+    const size_t N = 3 * ufl::FusedOps<double>::resync_interval + 500;
+    for (int threads : {1, 3})
+    {
+        upfirlerp.set_threads(threads);
+        std::vector<std::complex<double>> plain, out;
+        upfirlerp.interpolate_uniform(input, T, t0, dt, N, plain);
+
+        ufl::FusedOps<double> ops;
+        ops.set_gain(gain).set_mixer(freq, phase).set_reference(reference.data());
+        upfirlerp.interpolate_uniform(input, T, t0, dt, N, out, ops);
+
+        std::complex<double> dot = 0;
+        for (size_t k = 0; k < N; ++k)
+        {
+            const double t = t0 + k * dt;
+            if (t < 0)
+                continue;
+            check(out[k], mixed(plain[k], t));
+            dot += std::conj(reference[k]) * out[k];
+        }
+        check(ops.get_dot(), dot);
+    }
+}
+
+TEST_CASE("overlap-save engine matches dot products", "[interpolate],[fft]")
+{
+    SECTION("fft matches a direct transform")
+    {
+        for (size_t n : {1, 2, 8, 64})
+        {
+            auto x = random_input<double>(n);
+            auto y = x;
+            ufl::Fft<double> fft(n);
+            fft.forward(y.data());
+            for (size_t k = 0; k < n; k++)
+            {
+                std::complex<double> expected = 0;
+                for (size_t i = 0; i < n; i++)
+                    expected += x[i] * std::polar(1.0, -2 * 3.141592653589793 * (double)(i * k % n) / n);
+                REQUIRE_THAT(y[k].real(), Catch::Matchers::WithinAbs(expected.real(), 1e-12));
+                REQUIRE_THAT(y[k].imag(), Catch::Matchers::WithinAbs(expected.imag(), 1e-12));
+            }
+
+            fft.inverse(y.data());
+            for (size_t i = 0; i < n; i++)
+            {
+                REQUIRE_THAT(y[i].real() / n, Catch::Matchers::WithinAbs(x[i].real(), 1e-12));
+                REQUIRE_THAT(y[i].imag() / n, Catch::Matchers::WithinAbs(x[i].imag(), 1e-12));
+            }
+        }
+    }
+
+    // Sub-filters of 120 taps over an input a few transform blocks long
+    auto taps = random_taps<double>(600);
+    auto input = random_input<double>(3000);
+    double T = 0.01;
+    auto check = [](const std::vector<std::complex<double>>& a, const std::vector<std::complex<double>>& b){
+        REQUIRE(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            REQUIRE_THAT(a[i].real(), Catch::Matchers::WithinAbs(b[i].real(), 1e-9));
+            REQUIRE_THAT(a[i].imag(), Catch::Matchers::WithinAbs(b[i].imag(), 1e-9));
+        }
+    };
+
+    ufl::UpfirLerp<double> direct, fft;
+    direct.set_up_rate(5).set_up_taps(taps).set_fft_crossover(0);
+    fft.set_up_rate(5).set_up_taps(taps).set_fft_crossover(1);
+    REQUIRE(!direct.uses_fft());
+    REQUIRE(fft.uses_fft());
+
+    // Dense times reaching past both ends, sorted and shuffled
+    std::vector<double> sorted_t(20000);
+    for (size_t i = 0; i < sorted_t.size(); ++i)
+        sorted_t[i] = (i / (double)sorted_t.size() * 1.04 - 0.02) * T * input.size();
+    std::vector<double> shuffled_t = sorted_t;
+    for (size_t i = shuffled_t.size() - 1; i > 0; i--)
+        std::swap(shuffled_t[i], shuffled_t[std::rand() % (i + 1)]);
+
+    for (int threads : {1, 3})
+    {
+        direct.set_threads(threads);
+        fft.set_threads(threads);
+
+        SECTION("sorted, " + std::to_string(threads) + " threads")
+        {
+            std::vector<std::complex<double>> expected, result;
+            direct.interpolate(input, T, sorted_t, expected);
+            fft.interpolate(input, T, sorted_t, result);
+            check(result, expected);
+        }
+
+        SECTION("block engine, " + std::to_string(threads) + " threads")
+        {
+            direct.set_strategy(ufl::Strategy::Block);
+            fft.set_strategy(ufl::Strategy::Block);
+            std::vector<std::complex<double>> expected, result;
+            direct.interpolate(input, T, shuffled_t, expected);
+            fft.interpolate(input, T, shuffled_t, result);
+            check(result, expected);
+        }
+
+        SECTION("uniform grid, " + std::to_string(threads) + " threads")
+        {
+            const double t0 = -0.02 * T * input.size(), dt = 1.04 * T * input.size() / sorted_t.size();
+            std::vector<std::complex<double>> expected(sorted_t.size()), result(sorted_t.size());
+            direct.interpolate_uniform_array(input.data(), input.size(), T, t0, dt, expected.size(), expected.data());
+            fft.interpolate_uniform_array(input.data(), input.size(), T, t0, dt, result.size(), result.data());
+            check(result, expected);
+        }
+    }
+
+    SECTION("int16 input")
+    {
+        auto iq = random_iq<int16_t>(3000);
+        std::vector<float> ftaps(taps.begin(), taps.end());
+        ufl::UpfirLerp<float, int16_t> direct16, fft16;
+        direct16.set_up_rate(5).set_up_taps(ftaps).set_input_scale(1.0f / 32768).set_fft_crossover(0);
+        fft16.set_up_rate(5).set_up_taps(ftaps).set_input_scale(1.0f / 32768).set_fft_crossover(1);
+
+        std::vector<std::complex<float>> expected, result;
+        direct16.interpolate(iq, T, sorted_t, expected);
+        fft16.interpolate(iq, T, sorted_t, result);
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            REQUIRE_THAT(result[i].real(), Catch::Matchers::WithinAbs(expected[i].real(), 1e-3));
+            REQUIRE_THAT(result[i].imag(), Catch::Matchers::WithinAbs(expected[i].imag(), 1e-3));
+        }
+    }
+
+    SECTION("sparse times stay on dot products")
+    {
+        std::vector<double> sparse(20);
+        for (auto& v : sparse)
+            v = std::rand() / (double)RAND_MAX * T * input.size();
+        std::sort(sparse.begin(), sparse.end());
+
+        std::vector<std::complex<double>> expected, result;
+        direct.interpolate(input, T, sparse, expected);
+        fft.interpolate(input, T, sparse, result);
+        for (size_t i = 0; i < result.size(); i++)
+            REQUIRE(result[i] == expected[i]);
+    }
+
+    SECTION("the default crossover switches on long filters only")
+    {
+        ufl::UpfirLerp<float> upfirlerp;
+        REQUIRE(upfirlerp.get_fft_crossover() == ufl::UpfirLerp<float>::default_fft_crossover);
+        upfirlerp.set_up_rate(4).set_up_taps(random_taps<float>(64));
+        REQUIRE(!upfirlerp.uses_fft());
+        upfirlerp.set_up_taps(random_taps<float>(4 * ufl::UpfirLerp<float>::default_fft_crossover));
+        REQUIRE(upfirlerp.uses_fft());
+    }
+}
+
+TEST_CASE("async queue matches synchronous calls, in order", "[interpolate],[async]")
+{
+    const double T = 0.01;
+    const int up = 4;
+    const size_t blocks = 12, block_len = 700, outputs = 1500;
+
+    // Auto may pick another strategy call by call, which rounds differently, so the comparison pins one
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(up).set_up_taps(random_taps<double>(33)).set_threads(2).set_strategy(ufl::Strategy::PerPoint);
+
+    std::vector<std::vector<std::complex<double>>> inputs(blocks);
+    std::vector<std::vector<double>> times(blocks);
+    std::vector<std::vector<std::complex<double>>> expected(blocks);
+    for (size_t b = 0; b < blocks; b++)
+    {
+        inputs[b] = random_input<double>(block_len);
+        // Inside the signal, since reused buffers keep whatever outputs outside it held before
+        times[b].resize(outputs);
+        for (auto& v : times[b])
+            v = std::rand() / (double)RAND_MAX * T * (block_len - 1);
+        upfirlerp.interpolate(inputs[b], T, times[b], expected[b]);
+    }
+
+    SECTION("futures and callbacks complete in submission order")
+    {
+        std::vector<std::vector<std::complex<double>>> results(blocks, std::vector<std::complex<double>>(outputs));
+        std::vector<size_t> order;
+        std::vector<std::future<void>> futures;
+        {
+            ufl::AsyncQueue<ufl::UpfirLerp<double>> queue(upfirlerp, 2);
+            for (size_t b = 0; b < blocks; b++)
+            {
+                // Odd blocks go through the generic form
+                auto done = [&order, b]{ order.push_back(b); };
+                if (b % 2 == 0)
+                    futures.push_back(queue.submit(inputs[b].data(), block_len, T, times[b].data(), outputs, results[b].data(), done));
+                else
+                    futures.push_back(queue.submit([&, b](ufl::UpfirLerp<double>& ufl) {
+                        ufl.interpolate_array(inputs[b].data(), block_len, T, times[b].data(), outputs, results[b].data());
+                    }, done));
+                REQUIRE(queue.in_flight() <= queue.get_depth());
+            }
+            futures.front().get();
+            queue.wait();
+            REQUIRE(queue.in_flight() == 0);
+        }
+
+        for (size_t b = 0; b < blocks; b++)
+        {
+            REQUIRE(order[b] == b);
+            REQUIRE(results[b] == expected[b]);
+        }
+    }
+
+    SECTION("errors reach the future and skip the callback")
+    {
+        ufl::AsyncQueue<ufl::UpfirLerp<double>> queue(upfirlerp);
+        std::vector<std::complex<double>> out(outputs);
+        bool called = false;
+        auto bad = queue.submit_uniform(inputs[0].data(), block_len, T, 0.0, -T, outputs, out.data(), [&]{ called = true; });
+        auto thrown = queue.submit([](ufl::UpfirLerp<double>&) {}, []{ throw std::runtime_error("downstream"); });
+        auto good = queue.submit_uniform(inputs[0].data(), block_len, T, 0.0, T / up, outputs, out.data());
+
+        REQUIRE_THROWS_AS(bad.get(), std::invalid_argument);
+        REQUIRE_THROWS_AS(thrown.get(), std::runtime_error);
+        good.get();
+        REQUIRE(!called);
+
+        std::vector<std::complex<double>> uniform;
+        upfirlerp.interpolate_uniform(inputs[0], T, 0.0, T / up, outputs, uniform);
+        REQUIRE(out == uniform);
+    }
+
+    SECTION("callbacks may submit and wait")
+    {
+        // Each callback submits the next block into a queue of depth 1, which is full from outside;
+        // the last one also waits for the jobs to compute
+        std::vector<std::vector<std::complex<double>>> results(blocks, std::vector<std::complex<double>>(outputs));
+        ufl::AsyncQueue<ufl::UpfirLerp<double>> queue(upfirlerp, 1);
+        std::function<void(size_t)> chain = [&](size_t b) {
+            queue.submit(inputs[b].data(), block_len, T, times[b].data(), outputs, results[b].data(), [&, b]{
+                if (b + 1 < blocks)
+                    chain(b + 1);
+                else
+                    queue.wait();
+            });
+        };
+        chain(0);
+        queue.wait();
+
+        for (size_t b = 0; b < blocks; b++)
+            REQUIRE(results[b] == expected[b]);
+    }
+
+    SECTION("a triple-buffered pipeline matches")
+    {
+        struct Slot
+        {
+            std::vector<std::complex<double>> in;
+            std::vector<std::complex<double>> out;
+        };
+        std::vector<std::vector<std::complex<double>>> results(blocks);
+
+        ufl::AsyncQueue<ufl::UpfirLerp<double>> queue(upfirlerp);
+        ufl::BufferRing<Slot> ring(3);
+        for (size_t s = 0; s < ring.size(); s++)
+        {
+            ring[s].in.resize(block_len);
+            ring[s].out.resize(outputs);
+        }
+
+        for (size_t b = 0; b < blocks; b++)
+        {
+            Slot& slot = ring.acquire();
+            std::copy(inputs[b].begin(), inputs[b].end(), slot.in.begin());
+            ring.release(queue.submit(slot.in.data(), block_len, T, times[b].data(), outputs, slot.out.data(),
+                                      [&results, &slot, b]{ results[b] = slot.out; }));
+        }
+        REQUIRE_THROWS_AS(ring.release(std::future<void>()), std::logic_error);
+        ring.drain();
+
+        for (size_t b = 0; b < blocks; b++)
+            REQUIRE(results[b] == expected[b]);
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef UFL_ENABLE_STATS
+#define UFL_ENABLE_STATS
+#endif
+#include "upfirlerp.h"
+#include "streaming.h"
+#include <vector>
+#include <complex>
+#include <cstdlib>
+#include <cmath>
+
+#include <catch2/catch_test_macros.hpp>
+
+// Built with the counters compiled in; checks that they add up to what each call did.
+
+static std::vector<std::complex<double>> make_input(size_t len)
+{
+    std::vector<std::complex<double>> input(len);
+    for (auto& v : input)
+        v = std::complex<double>(std::rand() / (double)RAND_MAX, std::rand() / (double)RAND_MAX);
+    return input;
+}
+
+TEST_CASE("stats count outputs, skips and work", "[stats]")
+{
+    std::vector<double> taps(40, 0.1);
+    auto input = make_input(1000);
+    double T = 0.01;
+    const double t_max = T / 4 * (input.size() * 4 - 1);
+
+    // Unsorted, with roughly half of it outside the signal
+    std::vector<double> t(10000);
+    size_t valid = 0;
+    for (auto& v : t)
+    {
+        v = (std::rand() / (double)RAND_MAX * 2 - 0.5) * T * input.size();
+        valid += v >= 0 && v <= t_max;
+    }
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(4).set_up_taps(taps).set_strategy(ufl::Strategy::PerPoint);
+    REQUIRE(upfirlerp.stats_enabled);
+
+    std::vector<std::complex<double>> out;
+
+    SECTION("single thread")
+    {
+        upfirlerp.interpolate(input, T, t, out);
+        const ufl::CallStats& stats = upfirlerp.get_last_stats();
+        REQUIRE(stats.threads.size() == 1);
+
+        ufl::ThreadStats total = stats.total();
+        REQUIRE(total.outputs == valid);
+        REQUIRE(total.skipped == t.size() - valid);
+        // Unsorted per-point evaluates both neighbours of every output
+        REQUIRE(total.interrim == 2 * valid);
+        REQUIRE(total.macs > 0);
+        REQUIRE(total.macs <= total.interrim * 10);
+        REQUIRE(stats.seconds > 0);
+    }
+
+    SECTION("threads")
+    {
+        for (auto schedule : {ufl::Schedule::Static, ufl::Schedule::Dynamic})
+        {
+            upfirlerp.set_threads(3).set_schedule(schedule, 64);
+            upfirlerp.interpolate(input, T, t, out);
+            const ufl::CallStats& stats = upfirlerp.get_last_stats();
+            REQUIRE(stats.threads.size() == 3);
+
+            ufl::ThreadStats total = stats.total();
+            REQUIRE(total.outputs == valid);
+            REQUIRE(total.skipped == t.size() - valid);
+            REQUIRE(stats.imbalance() >= 1.0);
+            REQUIRE(stats.imbalance() <= 3.0);
+        }
+    }
+
+    SECTION("sorted, skipped by bisection")
+    {
+        std::sort(t.begin(), t.end());
+        upfirlerp.set_threads(2);
+        upfirlerp.interpolate(input, T, t, out);
+
+        ufl::ThreadStats total = upfirlerp.get_last_stats().total();
+        REQUIRE(total.outputs == valid);
+        REQUIRE(total.skipped == t.size() - valid);
+        // Carried pairs need no more than one new interrim sample per output after the first of each chunk
+        REQUIRE(total.interrim <= valid + 2 * 2);
+    }
+
+    SECTION("uniform grid and block engine")
+    {
+        out.resize(5000);
+        upfirlerp.interpolate_uniform_array(input.data(), input.size(), T, -1.0, 0.003, out.size(), out.data());
+        ufl::ThreadStats total = upfirlerp.get_last_stats().total();
+        REQUIRE(total.outputs + total.skipped == out.size());
+        REQUIRE(total.skipped > 0);
+
+        upfirlerp.set_strategy(ufl::Strategy::Block);
+        upfirlerp.interpolate(input, T, t, out);
+        total = upfirlerp.get_last_stats().total();
+        REQUIRE(total.outputs == valid);
+        REQUIRE(total.skipped == t.size() - valid);
+    }
+
+    SECTION("stream")
+    {
+        ufl::StreamUpfirLerp<double> stream;
+        stream.set_up_rate(4).set_up_taps(taps).set_input_period(T);
+        stream.push(input);
+        stream.finish();
+
+        std::sort(t.begin(), t.end());
+        out.resize(t.size());
+        REQUIRE(stream.pull(t.data(), t.size(), out.data()) == t.size());
+        ufl::ThreadStats total = stream.get_last_stats().total();
+        REQUIRE(total.outputs == valid);
+        REQUIRE(total.skipped == t.size() - valid);
+    }
+}
+
+TEST_CASE("folded symmetric taps count half the multiplies", "[stats],[symmetry]")
+{
+    // Odd length at an upsample rate of 2, so both sub-filters mirror themselves
+    std::vector<double> taps(129);
+    for (size_t k = 0; k < taps.size(); k++)
+        taps[k] = 1.0 / (1.0 + std::abs(static_cast<double>(k) - 64.0));
+    auto input = make_input(1000);
+    double T = 0.01;
+
+    // Far enough from both ends that every window lies inside the signal
+    std::vector<double> t(5000);
+    for (auto& v : t)
+        v = (0.1 + std::rand() / (double)RAND_MAX * 0.8) * T * input.size();
+
+    // Dot products only, which is what folds
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_fft_crossover(0);
+    std::vector<std::complex<double>> out;
+
+    upfirlerp.set_up_rate(2).set_up_taps(taps, ufl::Symmetry::None);
+    upfirlerp.interpolate(input, T, t, out);
+    const ufl::ThreadStats plain = upfirlerp.get_last_stats().total();
+
+    upfirlerp.set_up_taps(taps);
+    REQUIRE(upfirlerp.get_tap_symmetry() == ufl::Symmetry::Even);
+    upfirlerp.interpolate(input, T, t, out);
+    const ufl::ThreadStats folded = upfirlerp.get_last_stats().total();
+
+    REQUIRE(folded.interrim == plain.interrim);
+    // 65 and 64 taps per sub-filter fold to 33 and 32 multiplies
+    REQUIRE(plain.macs >= 64 * plain.interrim);
+    REQUIRE(folded.macs <= 33 * folded.interrim);
+}
+
+TEST_CASE("overlap-save spans count interrim samples but no multiplies", "[stats],[fft]")
+{
+    std::vector<double> taps(1024, 0.5);
+    auto input = make_input(5000);
+    double T = 0.01;
+
+    // A dense sorted walk over the whole input
+    std::vector<double> t(40000);
+    for (size_t i = 0; i < t.size(); i++)
+        t[i] = i / (double)t.size() * T * input.size();
+
+    ufl::UpfirLerp<double> upfirlerp;
+    upfirlerp.set_up_rate(8).set_up_taps(taps);
+    REQUIRE(upfirlerp.uses_fft());
+    std::vector<std::complex<double>> out;
+    upfirlerp.interpolate(input, T, t, out);
+
+    const ufl::ThreadStats total = upfirlerp.get_last_stats().total();
+    REQUIRE(total.outputs == t.size());
+    REQUIRE(total.macs == 0);
+    // Every interrim sample of the walk, once but for the input position where consecutive spans meet
+    REQUIRE(total.interrim >= input.size() * 8);
+    REQUIRE(total.interrim <= input.size() * 8 * 101 / 100);
+}